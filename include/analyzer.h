@@ -1,12 +1,16 @@
 #pragma once
 
+#include <functional>
+#include <string>
 #include <thread>
 #include <unordered_set>
 #include <shared_mutex>
+#include <vector>
 
 #include "logger.h"
 #include "events_handler.h"
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 
 
 namespace flow_inspector {
@@ -22,6 +26,8 @@ namespace flow_inspector {
  */
 class Analyzer {
  public:
+  using StatsSource = ::std::function<::std::string()>;
+
   /**
    * @brief Конструктор анализатора трафика.
    * @param logger Система логирования для записи событий.
@@ -35,6 +41,7 @@ class Analyzer {
    * 
    * Основной метод обработки пакетов, проверяет каждый пакет на соответствие всем правилам.
    * При обнаружении совпадения с правилом, генерирует соответствующее событие.
+   * Совпадение с правилом Alert отмечается в пакете, чтобы inline-источник мог его отбросить.
    */
   void detectThreats(const internal::Packet& packet) noexcept;
 
@@ -51,12 +58,63 @@ class Analyzer {
    */
   size_t getSignaturesCount() const noexcept;
 
+  /**
+   * @brief Строит BPF-выражение, пропускающее все пакеты, которые может поймать хотя бы одно правило.
+   * @return Дизъюнкция выражений правил или пустая строка, если фильтровать нельзя.
+   *
+   * Если хотя бы одно правило не ограничивает заголовки (например, состоит только из raw_bytes),
+   * или правил нет, возвращается пустая строка и предварительная фильтрация отключается.
+   * Кадры с VLAN, MPLS, GRE, VXLAN и IP-in-IP пропускаются всегда, так как сигнатуры видят вложенные в них заголовки.
+   */
+  ::std::string getCaptureFilter() const noexcept;
+
+  /**
+   * @brief Строит описания синтетических пакетов, на которых срабатывают загруженные правила.
+   * @return Описания пакетов, упорядоченные по именам правил.
+   *
+   * Правила, сигнатуры которых нельзя удовлетворить синтетическим пакетом, пропускаются.
+   */
+  ::std::vector<internal::PacketBlueprint> getRuleBlueprints() const noexcept;
+
+  /**
+   * @brief Вычисляет, сколько байт от начала кадра достаточно захватывать для загруженных правил.
+   * @return Наибольшая проверяемая длина среди правил или 0, если кадры нужны целиком.
+   *
+   * Правила с content и raw_bytes без смещения, а также правила сохранения в pcap
+   * требуют кадров целиком. Без правил также возвращается 0.
+   */
+  uint32_t getSnapshotLength() const noexcept;
+
+  /**
+   * @brief Проверяет, читают ли загруженные правила заголовки пакетов.
+   * @return false если правила смотрят только в сырые байты.
+   *
+   * Заголовки разбираются заранее выбранным декодером канального уровня только в первом случае.
+   */
+  bool usesHeaders() const noexcept;
+
+  /**
+   * @brief Выбирает декодер заголовков по типу канального уровня источника пакетов.
+   * @param link_type Тип канального уровня, который сообщает источник.
+   *
+   * Вызывается до начала анализа. Пакеты другого типа разбираются декодером, выбранным по их собственному типу.
+   */
+  void setLinkLayerType(::pcpp::LinkLayerType link_type) noexcept;
+
   /**
    * @brief Устанавливает интервал вывода статистики обработки пакетов.
    * @param interval Интервал в секундах. 0 для отключения вывода статистики.
    */
   void setStatSpeed(size_t interval) noexcept;
 
+  /**
+   * @brief Устанавливает источник дополнительной статистики, выводимой вместе со скоростью обработки.
+   * @param source Функция, возвращающая строку статистики. Непустая строка также записывается в журнал.
+   *
+   * Должен быть установлен до включения вывода статистики через setStatSpeed.
+   */
+  void setStatsSource(StatsSource source) noexcept;
+
   /**
    * @brief Обновляет правила из указанного файла.
    * @param filename Путь к файлу правил.
@@ -115,6 +173,11 @@ class Analyzer {
    */
   void loadRule(internal::Rule rule) noexcept;
 
+  /**
+   * @brief Пересчитывает, нужны ли правилам заголовки, после изменения набора правил. Вызывается под блокировкой правил.
+   */
+  void updateUsesHeaders() noexcept;
+
   /**
    * @brief Потоковая функция для вывода статистики обработки пакетов.
    * 
@@ -128,12 +191,16 @@ class Analyzer {
       ::std::unique_ptr<internal::Signature>,
       internal::UniquePtrSignatureHash,
       internal::UniquePtrSignatureEqual> signatures_; ///< Набор уникальных сигнатур
+  bool uses_headers_{false}; ///< Правилам нужны заголовки пакетов
+  ::pcpp::LinkLayerType link_type_{::pcpp::LinkLayerType::LINKTYPE_ETHERNET}; ///< Тип канального уровня источника
+  internal::LinkDecoder link_decoder_{nullptr}; ///< Декодер заголовков для кадров источника
 
   Logger& logger_; ///< Система логирования
   EventsHandler& events_handler_; ///< Обработчик событий
   ::std::atomic<size_t> packets_count_; ///< Счетчик обработанных пакетов для статистики
   ::std::atomic<bool> done_{false}; ///< Флаг завершения работы
   ::std::size_t stat_interval_{0}; ///< Интервал вывода статистики в секундах
+  StatsSource stats_source_; ///< Источник дополнительной статистики
 
   ::std::thread stats_printer_{&Analyzer::printStats, this}; ///< Поток вывода статистики
 };
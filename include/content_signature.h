@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <unordered_set>
 #include <regex>
@@ -34,6 +35,8 @@ class ContentSignature : public Signature {
 
   size_t hash() const noexcept override;
 
+  bool fillBlueprint(PacketBlueprint& blueprint) const noexcept override;
+
   static ::std::unique_ptr<Signature> createContentSignature(const ::std::string& initString) noexcept;
 
  private:
@@ -42,9 +45,7 @@ class ContentSignature : public Signature {
   ::std::unordered_set<::std::string> flags_;
   ::std::regex_constants::syntax_option_type regex_flags_ = ::std::regex_constants::ECMAScript;
 
-  bool extractTcpPayload(const Packet& packet, ::std::string& payload) const noexcept;
-
-  bool extractUdpPayload(const Packet& packet, ::std::string& payload) const noexcept;
+  bool extractPayload(const Packet& packet, uint8_t protocol, ::std::string_view& payload) const noexcept;
 };
 
 
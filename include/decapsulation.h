@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+constexpr uint16_t kVxlanPort{4789}; ///< UDP-порт назначения VXLAN
+
+
+/**
+ * @brief Читает 16-битное число в сетевом порядке байтов.
+ * @param data Указатель на первый байт.
+ * @return Число в порядке байтов машины.
+ */
+inline uint16_t readBigEndian16(const byte* data) noexcept {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+
+/**
+ * @brief Читает 32-битное число в сетевом порядке байтов.
+ * @param data Указатель на первый байт.
+ * @return Число в порядке байтов машины.
+ */
+inline uint32_t readBigEndian32(const byte* data) noexcept {
+  return (static_cast<uint32_t>(readBigEndian16(data)) << 16) | readBigEndian16(data + 2);
+}
+
+
+/**
+ * @brief Находит самые внутренние заголовки IP и L4 кадра, проходя по смещениям заголовков.
+ * @param data Данные кадра.
+ * @param length Длина кадра.
+ * @param link_type Тип канального уровня.
+ * @param view Представление, в которое записываются найденные заголовки.
+ * @return true если найден хотя бы один IP-заголовок.
+ *
+ * Снимаются VLAN и QinQ, стек меток MPLS, GRE (с Ethernet или IP внутри), VXLAN и IP-in-IP.
+ * Адреса, порты и флаги внутренних заголовков сохраняются в представлении, а полезная нагрузка
+ * ссылается на данные кадра. Данные не копируются и не разбираются повторно: каждый заголовок читается один раз.
+ */
+bool decapsulate(const byte* data, size_t length, ::pcpp::LinkLayerType link_type, PacketView& view) noexcept;
+
+
+/**
+ * @brief Выбирает декодер, собранный под конкретный тип канального уровня.
+ * @param link_type Тип канального уровня кадров.
+ * @return Декодер, который заполняет представление так же, как decapsulate, но без ветвления по типу кадра.
+ *
+ * Поддерживаются Ethernet, Linux SLL и SLL2, сырой IP и BSD loopback (NULL и LOOP).
+ * Для остальных типов декодер возвращает false.
+ */
+LinkDecoder selectLinkDecoder(::pcpp::LinkLayerType link_type) noexcept;
+
+
+}  // namespace flow_inspector::internal
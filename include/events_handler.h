@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -11,6 +12,28 @@
 namespace flow_inspector {
 
 
+class EventsHandler;
+
+
+class DeferredEvents {
+ public:
+  void commit() noexcept;
+
+  size_t size() const noexcept;
+
+ private:
+  friend class EventsHandler;
+
+  struct Entry {
+    EventsHandler* handler;
+    internal::Rule rule;
+    internal::SharedPacket packet;
+  };
+
+  ::std::vector<Entry> entries_;
+};
+
+
 class EventsHandler {
  public:
   using EventCallback = ::std::function<void(const internal::Event&)>;
@@ -21,9 +44,20 @@ class EventsHandler {
 
   void addEvent(const internal::Event& event) noexcept;
 
+  static void deferEvents(DeferredEvents* events) noexcept;
+
+  void setAlertPayloadPrefix(::std::optional<size_t> payload_prefix) noexcept;
+
  private:
+  friend class DeferredEvents;
+
+  void dispatchEvent(const internal::Event& event) noexcept;
+
+  static thread_local DeferredEvents* deferred_events_;
+
   ::std::unordered_map<internal::Event::EventType, ::std::vector<EventCallback>> callbacks_;
   Logger& logger_;
+  ::std::optional<size_t> alert_payload_prefix_;
 };
 
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "packet_origin.h"
+#include "packet_ring.h"
+
+
+namespace flow_inspector {
+
+
+class FanoutCapturer : public PacketOrigin {
+ public:
+  void setInterfaceName(const ::std::string& interface_name) noexcept;
+
+  void setRingConfig(const internal::PacketRing::Config& config) noexcept;
+
+  void setWorkersCount(uint8_t workers_count) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  bool hasOwnWorkers() const noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  static uint16_t chooseGroupId(uint32_t pid, uint32_t ifindex, const ::std::set<uint16_t>& used) noexcept;
+
+ private:
+  static constexpr int kPollTimeoutMs{100};
+
+  void readRing(internal::PacketRing& ring) noexcept;
+
+  void updateStatistics(const ::std::vector<::std::unique_ptr<internal::PacketRing>>& rings) noexcept;
+
+  ::std::string interface_name_;
+  internal::PacketRing::Config config_;
+  uint8_t workers_count_{1};
+};
+
+
+}  // namespace flow_inspector
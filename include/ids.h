@@ -1,9 +1,14 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <span>
+
 #include "analyzer.h"
 #include "events_handler.h"
 #include "pcap_writer.h"
 #include "logger.h"
+#include "packet_deduplicator.h"
 #include "packet_processors_pool.h"
 #include "packet_origin.h"
 
@@ -24,6 +29,9 @@ public:
    * @brief Конструктор системы обнаружения вторжений.
    * @param numPacketProcessors Количество обработчиков пакетов для параллельной обработки трафика.
    * @param origin Источник сетевого трафика (pcap-файл или сетевой интерфейс).
+   *
+   * Если источник сам распределяет пакеты по своим потокам, пакеты анализируются
+   * прямо в этих потоках, а пул обработчиков не создает собственных потоков.
    */
   IDS(const uint8_t numPacketProcessors, ::std::unique_ptr<PacketOrigin> origin) noexcept;
   
@@ -32,8 +40,9 @@ public:
    * 
    * Начинает мониторинг трафика из указанного источника 
    * и запускает обработку с применением правил обнаружения.
+   * @return false если источник пакетов не удалось запустить.
    */
-  void start() noexcept;
+  bool start() noexcept;
   
   /**
    * @brief Останавливает захват и анализ пакетов.
@@ -43,9 +52,50 @@ public:
   /**
    * @brief Загружает правила обнаружения из указанного файла.
    * @param filename Путь к файлу с правилами.
+   *
+   * Если включена предварительная фильтрация, источнику передаются BPF-фильтр и длина
+   * захватываемой части кадра, построенные по новым правилам. Генераторам трафика передаются описания пакетов,
+   * на которых срабатывают правила.
    */
   void loadRules(const ::std::string& filename) noexcept;
   
+  /**
+   * @brief Включает или отключает предварительную фильтрацию трафика в ядре по загруженным правилам.
+   * @param enabled true для включения (по умолчанию включена).
+   */
+  void setPrefilterEnabled(bool enabled) noexcept;
+  
+  /**
+   * @brief Ограничивает очередь пакетов, ожидающих обработки.
+   * @param max_queue_depth Максимальное количество пакетов в очереди, 0 без ограничения.
+   *
+   * Пакеты, пришедшие при заполненной очереди, отбрасываются и учитываются в статистике.
+   */
+  void setQueueLimit(size_t max_queue_depth) noexcept;
+  
+  /**
+   * @brief Включает отбрасывание повторных копий пакетов перед их обработкой.
+   * @param config Параметры дедупликации.
+   *
+   * Вызывается до запуска захвата. Количество отброшенных повторов попадает в статистику.
+   */
+  void setDeduplication(const internal::PacketDeduplicator::Config& config) noexcept;
+  
+  /**
+   * @brief Ограничивает часть пакета, которая хранится в журнале вместе с тревогой.
+   * @param payload_prefix Сколько байт полезной нагрузки сохранить после заголовков, nullopt для пакета целиком.
+   *
+   * Пакет целиком хранится без копирования, но удерживает буфер кадра до ротации журнала.
+   */
+  void setAlertPayloadPrefix(::std::optional<size_t> payload_prefix) noexcept;
+  
+  /**
+   * @brief Формирует сводку потерь при захвате и обработке пакетов.
+   * @return Строка со счетчиками источника (если он их ведет), глубиной очереди, отброшенными пакетами
+   * и повторами (если включена дедупликация).
+   */
+  ::std::string getCaptureStatistics() noexcept;
+  
   /**
    * @brief Устанавливает уровень детализации логирования.
    * @param level Уровень логирования (DEBUG, INFO, WARNING, ERROR).
@@ -71,17 +121,21 @@ public:
   void setPcapOutputFilename(const ::std::string& filename) noexcept;
   
   /**
-   * @brief Деструктор. Завершает работу анализаторов и освобождает ресурсы.
+   * @brief Деструктор. Завершает работу анализаторов, записывает итоговую статистику и освобождает ресурсы.
    */
   ~IDS() noexcept;
 
  private:
+  ::std::span<internal::Packet> removeDuplicates(::std::span<internal::Packet> packets) noexcept;
+
   Logger logger_; /// Система журналирования событий и предупреждений
   EventsHandler events_handler_{logger_}; /// Обработчик событий безопасности
   Analyzer analyzer_{logger_, events_handler_}; /// Анализатор трафика и правил
   PcapWriter pcap_writer_; /// Модуль сохранения подозрительных пакетов
   PacketProcessorsPool pool_; /// Пул обработчиков пакетов
   ::std::unique_ptr<PacketOrigin> origin_; /// Источник сетевого трафика
+  bool prefilter_enabled_{true}; /// Флаг предварительной фильтрации трафика по правилам
+  ::std::unique_ptr<internal::PacketDeduplicator> deduplicator_; /// Фильтр повторов, если дедупликация включена
 };
 
 
@@ -1,6 +1,19 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "ids.h"
+#include "nfqueue_capturer.h"
+#include "packet_buffer_pool.h"
+#include "packet_deduplicator.h"
+#include "packet_ring.h"
+#include "replay_reader.h"
+#include "traffic_capturer.h"
+#include "traffic_generator.h"
+#include "xdp_capturer.h"
 
 
 namespace flow_inspector {
@@ -12,19 +25,38 @@ class IdsCli {
   
   void updateRules() noexcept;
 
-  void start() noexcept;
+  bool start() noexcept;
 
   void stop() noexcept;
 
  private:
+  ::std::unique_ptr<PacketOrigin> makeCapturer(const ::std::string& interface_name) noexcept;
+
   ::std::string mode_;
-  ::std::string interface_;
+  ::std::vector<::std::string> interfaces_;
   ::std::string pcap_file_;
+  bool mmap_pcap_{false};
+  bool chunked_pcap_{false};
+  bool stream_pcap_{false};
+  ::std::vector<::std::string> pcap_files_;
+  uint8_t readers_{2};
   ::std::string pcap_output_file_;
   ::std::string rules_file_;
   ::std::string output_log_file_;
   uint8_t cores_;
   size_t stat_speed_;
+  bool prefilter_{true};
+  size_t queue_limit_{0};
+  internal::PacketDeduplicator::Config dedup_config_;
+  internal::PacketBufferPool::Config packet_pool_config_;
+  ::std::optional<size_t> alert_payload_prefix_;
+  TrafficCapturer::Config capture_config_;
+  internal::PacketRing::Config ring_config_;
+  XdpCapturer::Config xdp_config_;
+  ReplayReader::Config replay_config_;
+  TrafficGenerator::Config generator_config_;
+  NfqueueCapturer::Config nfqueue_config_;
+  ::std::string shm_ring_name_;
   ::std::optional<IDS> ids_;
   Logger::LogLevel log_level_{Logger::LogLevel::INFO};
 };
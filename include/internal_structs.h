@@ -44,12 +44,21 @@ namespace flow_inspector::internal {
 
 class Signature;
 class Rule;
+struct PacketBlueprint;
+class PacketBufferPool;
 
 /**
  * @brief Тип для представления байта данных
  */
 using byte = uint8_t;
 
+constexpr size_t kMaxLinkHeaderSize{64}; ///< Запас на канальные заголовки с VLAN- и MPLS-метками
+constexpr size_t kMaxIpHeaderSize{60}; ///< Максимальный размер заголовка IPv4 с опциями
+constexpr size_t kMaxTcpHeaderSize{60}; ///< Максимальный размер заголовка TCP с опциями
+constexpr uint8_t kMaxTunnelDepth{4}; ///< Сколько уровней туннелей снимается, прежде чем разбор останавливается
+constexpr size_t kMaxTunnelHeaderSize{128}; ///< Запас на один уровень туннеля: внешний IP, GRE или UDP с VXLAN, внутренний Ethernet
+constexpr size_t kMaxTunnelsHeaderSize{kMaxTunnelDepth * kMaxTunnelHeaderSize}; ///< Запас на все снимаемые уровни туннелей
+
 
 /**
  * @class ByteVector
@@ -138,6 +147,50 @@ ByteVector byteVectorFromPCPP(const ::pcpp::RawPacket& packet) noexcept;
     const ::std::vector<internal::byte>& vec, const timeval& timestamp = {}) noexcept;
 
 
+/**
+ * @struct PacketView
+ * @brief Заголовки кадра после снятия VLAN-, MPLS- и туннельной инкапсуляции, разобранные за один проход
+ *
+ * Смещения, адреса и порты относятся к самым внутренним заголовкам IP и L4, по которым проверяются правила.
+ * Сведения о внешних заголовках сохраняются отдельно. Структура занимает одну кэш-линию,
+ * а полезная нагрузка ссылается на данные кадра без копирования.
+ */
+struct alignas(64) PacketView {
+  /**
+   * @enum Tunnel
+   * @brief Тип самого внешнего снятого туннеля
+   */
+  enum class Tunnel : uint8_t {
+    None,
+    GRE,
+    VXLAN,
+    IPinIP,
+  };
+
+  ::std::span<const byte> payload; ///< Полезная нагрузка L4, ограниченная длиной кадра
+  uint32_t ip_offset{0}; ///< Смещение внутреннего IP-заголовка
+  uint32_t l4_offset{0}; ///< Смещение заголовка L4, 0 если его нет в кадре
+  uint32_t outer_ip_offset{0}; ///< Смещение самого внешнего IP-заголовка
+  uint32_t tunnel_id{0}; ///< VNI VXLAN или ключ GRE самого внешнего туннеля
+  uint32_t src_ip{0}; ///< Адрес источника внутреннего IPv4 в порядке байтов машины
+  uint32_t dst_ip{0}; ///< Адрес назначения внутреннего IPv4 в порядке байтов машины
+  uint16_t src_port{0}; ///< Порт источника TCP или UDP
+  uint16_t dst_port{0}; ///< Порт назначения TCP или UDP
+  uint16_t vlan_id{0}; ///< Внешняя VLAN-метка, 0 если ее нет
+  uint8_t ip_version{0}; ///< Версия внутреннего IP, 0 если IP-заголовок не найден
+  uint8_t protocol{0}; ///< Протокол L4 внутреннего IP
+  uint8_t tcp_flags{0}; ///< Флаги TCP (FIN, SYN, RST, PSH, ACK, URG, ECE, CWR)
+  uint8_t depth{0}; ///< Количество снятых уровней туннелей
+  Tunnel tunnel{Tunnel::None}; ///< Тип самого внешнего туннеля
+};
+
+static_assert(sizeof(PacketView) == 64, "PacketView must fit into a single cache line");
+
+
+/// Декодер заголовков кадров одного типа канального уровня, заполняющий PacketView
+using LinkDecoder = bool (*)(const byte* data, size_t length, PacketView& view) noexcept;
+
+
 /**
  * @class Packet
  * @brief Представляет сетевой пакет с возможностью анализа его содержимого
@@ -150,17 +203,35 @@ struct Packet {
   
   /**
    * @brief Создает пакет из сырого пакета pcpp
+   *
+   * Данные копируются в буфер из пула потока, а если буфера нет — в кучу.
    * @param _packet Сырой пакет
    * @param parse_at_init Флаг, указывающий, нужно ли сразу анализировать пакет
    */
   Packet(const ::pcpp::RawPacket& _packet, bool parse_at_init = false) noexcept;
   
+  /**
+   * @brief Создает пакет поверх чужого буфера без копирования данных
+   * @param data Указатель на данные кадра
+   * @param length Длина кадра
+   * @param timestamp Временная метка пакета
+   * @param link_type Тип канального уровня
+   * @param holder Владелец буфера; память остается валидной, пока жив хотя бы один пакет
+   */
+  Packet(const byte* data, size_t length, const timespec& timestamp,
+      ::pcpp::LinkLayerType link_type, ::std::shared_ptr<const void> holder) noexcept;
+  
   /**
    * @brief Перемещающий конструктор
    * @param other Другой пакет
    */
   Packet(Packet&& other) noexcept;
   
+  /**
+   * @brief Деструктор. Возвращает буфер и оболочки пакета в пул, из которого они взяты
+   */
+  ~Packet() noexcept;
+  
   /**
    * @brief Перемещающий оператор присваивания
    * @param other Другой пакет
@@ -196,6 +267,8 @@ struct Packet {
   
   /**
    * @brief Анализирует пакет, создавая его структурное представление
+   *
+   * Обычно не нужен: заголовки и структура пакета разбираются при первом обращении к ним.
    */
   void parse() noexcept;
   
@@ -206,18 +279,74 @@ struct Packet {
   Packet copy() const noexcept;
   
   /**
-   * @brief Получает проанализированную версию пакета
+   * @brief Копирует начало пакета
+   * @param length Сколько байт кадра скопировать
+   * @return Пакет с первыми length байтами кадра и исходной длиной кадра
+   */
+  Packet copyPrefix(size_t length) const noexcept;
+  
+  /**
+   * @brief Возвращает неизменяемый пакет с теми же данными, который можно хранить дольше текущего
+   * @return Разделяемый пакет, повторные вызовы возвращают его же
+   *
+   * Буфер из пула не копируется: он переходит к общему владельцу и освобождается вместе с последним пакетом.
+   * Кадр из кучи и кадр во внешнем буфере копируются один раз при первом вызове, чтобы долго хранимый
+   * пакет не удерживал блок кольца захвата или кадры UMEM.
+   */
+  ::std::shared_ptr<const Packet> share() const noexcept;
+  
+  /**
+   * @brief Возвращает пакет для долгого хранения, ограниченный заголовками и началом полезной нагрузки
+   * @param payload_prefix Сколько байт нагрузки L4 оставить после заголовков, nullopt для пакета целиком
+   * @return Разделяемый пакет или небольшая копия начала кадра
+   *
+   * Копия отпускает буфер кадра (например, блок кольца захвата) сразу, а не вместе с последним пакетом.
+   * Кадр без заголовка L4 и кадр, который помещается в границу целиком, не копируются.
+   */
+  ::std::shared_ptr<const Packet> retain(::std::optional<size_t> payload_prefix) const noexcept;
+  
+  /**
+   * @brief Получает проанализированную версию пакета, разбирая его при первом обращении
    * @return Ссылка на объект анализа пакета
    */
   const ::pcpp::Packet& getParsedPacket() const noexcept;
   
+  /**
+   * @brief Получает внутренние заголовки пакета, разбирая их за один проход при первом обращении
+   * @return Ссылка на разобранные заголовки
+   */
+  const PacketView& getView() const noexcept;
+  
+  /**
+   * @brief Получает внутренние заголовки пакета, разбирая их заранее выбранным декодером
+   * @param decoder Декодер типа канального уровня этого пакета
+   * @return Ссылка на разобранные заголовки
+   */
+  const PacketView& getView(LinkDecoder decoder) const noexcept;
+  
   ::std::unique_ptr<::pcpp::RawPacket> packet; ///< Сырые данные пакета
+  mutable bool alerted{false}; ///< Пакет совпал с правилом Alert (для вердиктов inline-режима)
   
  private:
-  ::std::unique_ptr<::pcpp::Packet> parsed_packet; ///< Проанализированная структура пакета
+  /**
+   * @brief Возвращает буфер и оболочки пакета в пул
+   */
+  void release() noexcept;
+  
+  mutable ::std::unique_ptr<::pcpp::Packet> parsed_packet; ///< Проанализированная структура пакета
+  mutable PacketView view_; ///< Заголовки после снятия инкапсуляции
+  mutable bool view_ready_{false}; ///< Заголовки уже разобраны
+  mutable ::std::shared_ptr<const void> holder_; ///< Владелец внешнего буфера или буфера из пула, отданного share
+  bool external_{false}; ///< holder_ владеет внешним буфером источника, а не буфером из пула
+  ::std::shared_ptr<PacketBufferPool> pool_; ///< Пул, из которого взяты оболочки пакета
+  mutable byte* buffer_{nullptr}; ///< Буфер кадра из пула, nullptr если данные в куче или во внешнем буфере
+  mutable ::std::shared_ptr<const Packet> shared_; ///< Разделяемый пакет, созданный share
 };
 
 
+using SharedPacket = ::std::shared_ptr<const Packet>; ///< Разделяемый неизменяемый пакет
+
+
 /**
  * @class Alert
  * @brief Представляет предупреждение безопасности
@@ -247,7 +376,7 @@ class Alert {
  */
 struct LogEntry {
   const ::std::time_t timestamp; ///< Временная метка события
-  ::std::optional<Packet> packet{}; ///< Связанный с событием пакет (если есть)
+  SharedPacket packet{}; ///< Связанный с событием пакет (если есть)
   ::std::optional<Alert> alert{}; ///< Предупреждение (если есть)
   ::std::optional<::std::string> message{}; ///< Текстовое сообщение (если есть)
 };
@@ -279,6 +408,31 @@ class Signature {
    */
   virtual bool operator==(const Signature& other) const noexcept = 0;
   
+  /**
+   * @brief Возвращает BPF-выражение, пропускающее все пакеты, которые могут удовлетворить сигнатуре
+   * @return Выражение в синтаксисе pcap-filter или пустая строка, если сигнатура не ограничивает заголовки
+   */
+  virtual ::std::string getCaptureFilter() const noexcept;
+  
+  /**
+   * @brief Дополняет описание синтетического пакета так, чтобы пакет удовлетворял сигнатуре
+   * @param blueprint Описание пакета, уже дополненное другими сигнатурами правила
+   * @return true в случае успеха, false если сигнатуру нельзя удовлетворить синтетическим пакетом
+   */
+  virtual bool fillBlueprint(PacketBlueprint& blueprint) const noexcept;
+  
+  /**
+   * @brief Возвращает, сколько байт от начала кадра нужно сигнатуре для проверки
+   * @return Длина проверяемой части кадра или 0, если сигнатура может смотреть в любую часть кадра
+   */
+  virtual size_t getInspectedLength() const noexcept;
+  
+  /**
+   * @brief Проверяет, читает ли сигнатура заголовки пакета
+   * @return false если сигнатура смотрит только в сырые байты кадра
+   */
+  virtual bool usesHeaders() const noexcept;
+  
   /**
    * @brief Виртуальный деструктор для корректного удаления наследников
    */
@@ -363,6 +517,33 @@ class Rule {
    */
   bool check(const Packet& packet) const noexcept;
   
+  /**
+   * @brief Возвращает BPF-выражение, пропускающее все пакеты, которые могут удовлетворить правилу
+   * @return Конъюнкция выражений сигнатур или пустая строка, если правило не ограничивает заголовки
+   */
+  ::std::string getCaptureFilter() const noexcept;
+  
+  /**
+   * @brief Заполняет описание синтетического пакета, на котором срабатывает правило
+   * @param blueprint Описание пакета
+   * @return true в случае успеха, false если хотя бы одну сигнатуру нельзя удовлетворить
+   */
+  bool fillBlueprint(PacketBlueprint& blueprint) const noexcept;
+  
+  /**
+   * @brief Возвращает, сколько байт от начала кадра нужно правилу для проверки и обработки события
+   * @return Наибольшая длина среди сигнатур или 0, если правилу нужен кадр целиком
+   *
+   * Правилам сохранения в pcap кадр нужен целиком независимо от сигнатур.
+   */
+  size_t getInspectedLength() const noexcept;
+  
+  /**
+   * @brief Проверяет, читает ли хотя бы одна сигнатура правила заголовки пакета
+   * @return true если заголовки нужны хотя бы одной сигнатуре
+   */
+  bool usesHeaders() const noexcept;
+  
   /**
    * @brief Оператор сравнения правил
    * @param other Другое правило
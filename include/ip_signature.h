@@ -35,6 +35,12 @@ class IPSignature: public Signature {
 
   size_t hash() const noexcept override;
 
+  ::std::string getCaptureFilter() const noexcept override;
+
+  bool fillBlueprint(PacketBlueprint& blueprint) const noexcept override;
+
+  size_t getInspectedLength() const noexcept override;
+
   static ::std::unique_ptr<Signature> createIPSignature(const ::std::string& initString) noexcept;
 
  private:
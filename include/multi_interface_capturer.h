@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class MultiInterfaceCapturer : public PacketOrigin {
+ public:
+  void addInterface(const ::std::string& interface_name, ::std::unique_ptr<PacketOrigin> capturer) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  bool hasOwnWorkers() const noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  ::std::string getStatistics() noexcept override;
+
+ private:
+  static constexpr ::std::chrono::milliseconds kPollInterval{100};
+
+  struct Interface {
+    ::std::string name;
+    ::std::unique_ptr<PacketOrigin> capturer;
+  };
+
+  const Interface* findFailedInterface() const noexcept;
+
+  void applyCaptureFilter() noexcept;
+
+  void updateStatistics() noexcept;
+
+  ::std::vector<Interface> interfaces_;
+  bool link_types_consistent_{true};
+  ::std::atomic<size_t> running_count_{0};
+};
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class MultiPcapReader : public PacketOrigin {
+ public:
+  MultiPcapReader() noexcept;
+
+  ~MultiPcapReader() noexcept;
+
+  static ::std::vector<::std::string> resolveInputs(const ::std::string& input) noexcept;
+
+  void setFilenames(::std::vector<::std::string> filenames) noexcept;
+
+  void setReadersCount(uint8_t readers_count) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+ private:
+  static constexpr size_t kStreamCapacity{1024};
+  static constexpr size_t kRefillBatch{256};
+  static constexpr ::std::chrono::milliseconds kWaitTime{100};
+
+  struct Stream;
+
+  void readStreams() noexcept;
+
+  void scheduleRefill(Stream& stream) noexcept;
+
+  bool takePacket(Stream& stream, internal::Packet& packet) noexcept;
+
+  ::std::vector<::std::string> input_files_;
+  uint8_t readers_count_{1};
+  bool link_types_consistent_{true};
+
+  ::std::mutex refill_mutex_;
+  ::std::condition_variable refill_condition_;
+  ::std::deque<Stream*> refill_queue_;
+};
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class NetfilterQueue
+ * @brief Очередь NFQUEUE, с которой процесс работает напрямую через сокет netlink.
+ *
+ * Ядро передает в очередь пакеты, отобранные правилами netfilter, и ждет по каждому вердикта.
+ * Пакеты принимаются пачкой в общий буфер и выдаются наружу без копирования, а вердикты
+ * отправляются одним сообщением: отдельные DROP для отброшенных пакетов и один пакетный
+ * ACCEPT для всех остальных.
+ */
+class NetfilterQueue {
+ public:
+  /**
+   * @brief Обработчик принятого пакета.
+   *
+   * Получает идентификатор пакета в очереди и сам пакет, начинающийся с IP-заголовка.
+   */
+  using PacketHandler = ::std::function<void(uint32_t, Packet)>;
+
+  /**
+   * @struct Config
+   * @brief Параметры очереди
+   */
+  struct Config {
+    uint32_t max_length{4096}; ///< Максимальное количество пакетов, ожидающих вердикта в ядре
+    bool fail_open{true}; ///< Пропускать пакеты, когда очередь переполнена или обработчики не успевают
+    size_t buffer_size{1u << 22}; ///< Размер буфера, в который принимается пачка пакетов
+  };
+
+  /**
+   * @struct Statistics
+   * @brief Счетчики очереди в ядре
+   */
+  struct Statistics {
+    uint64_t packets{0}; ///< Пакеты, поставленные в очередь с момента ее привязки
+    uint64_t queued{0}; ///< Пакеты, ожидающие вердикта в момент чтения счетчиков
+    uint64_t queue_drops{0}; ///< Пакеты, отброшенные ядром из-за переполнения очереди
+    uint64_t user_drops{0}; ///< Пакеты, не доставленные из-за переполнения буфера сокета
+  };
+
+  NetfilterQueue() noexcept;
+
+  /**
+   * @brief Деструктор. Отвязывает очередь, если она привязана.
+   */
+  ~NetfilterQueue() noexcept;
+
+  NetfilterQueue(const NetfilterQueue&) = delete;
+  NetfilterQueue& operator=(const NetfilterQueue&) = delete;
+
+  /**
+   * @brief Создает сокет netlink и привязывает его к очереди.
+   * @param queue_number Номер очереди NFQUEUE.
+   * @param config Параметры очереди.
+   * @return true в случае успеха, false при ошибке.
+   */
+  bool open(uint16_t queue_number, const Config& config) noexcept;
+
+  /**
+   * @brief Задает, сколько байт каждого пакета ядро копирует в процесс.
+   * @param copy_range Количество байт, 0 для пакетов целиком.
+   * @return true если запрос отправлен.
+   *
+   * Вердикт не требует данных пакета, поэтому достаточно той части, которую проверяют правила.
+   */
+  bool setCopyRange(uint32_t copy_range) noexcept;
+
+  /**
+   * @brief Отвязывает очередь и закрывает сокет.
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Принимает пачку пакетов.
+   * @param timeout_ms Максимальное время ожидания первого пакета в миллисекундах.
+   * @param max_packets Максимальное количество пакетов в пачке.
+   * @param handler Обработчик пакетов пачки.
+   * @return false при ошибке сокета, иначе true (в том числе по таймауту).
+   *
+   * Буфер пачки переиспользуется, только если не осталось выданных из него пакетов.
+   */
+  bool receive(int timeout_ms, size_t max_packets, const PacketHandler& handler) noexcept;
+
+  /**
+   * @brief Отправляет вердикты по пачке пакетов одним сообщением.
+   * @param dropped_ids Идентификаторы отбрасываемых пакетов.
+   * @param last_id Наибольший идентификатор пачки; остальные пакеты до него включительно пропускаются.
+   * @return true в случае успеха, false при ошибке.
+   */
+  bool sendVerdicts(::std::span<const uint32_t> dropped_ids, uint32_t last_id) noexcept;
+
+  /**
+   * @brief Возвращает счетчики очереди из /proc/net/netfilter/nfnetlink_queue.
+   * @return Счетчики очереди; нулевые, если очередь не привязана.
+   */
+  Statistics getStatistics() const noexcept;
+
+  /**
+   * @brief Дописывает в сообщение запрос привязки сокета к очереди.
+   * @param message Буфер сообщения netlink.
+   * @param sequence Номер запроса.
+   * @param queue_number Номер очереди NFQUEUE.
+   * @param config Параметры очереди.
+   */
+  static void buildBindRequest(
+      ::std::vector<byte>& message, uint32_t sequence, uint16_t queue_number, const Config& config) noexcept;
+
+  /**
+   * @brief Дописывает в сообщение вердикты по пачке пакетов.
+   * @param message Буфер сообщения netlink.
+   * @param sequence Номер последнего запроса, увеличивается на каждое сообщение.
+   * @param queue_number Номер очереди NFQUEUE.
+   * @param dropped_ids Идентификаторы отбрасываемых пакетов.
+   * @param last_id Наибольший идентификатор пачки.
+   */
+  static void buildVerdicts(::std::vector<byte>& message, uint32_t& sequence, uint16_t queue_number,
+      ::std::span<const uint32_t> dropped_ids, uint32_t last_id) noexcept;
+
+  /**
+   * @brief Разбирает сообщения netlink, принятые одним вызовом recv, и передает пакеты обработчику.
+   * @param data Начало принятых сообщений.
+   * @param length Длина принятых данных.
+   * @param now Временная метка для пакетов, у которых ядро ее не указало.
+   * @param holder Владелец буфера, который получает каждый пакет.
+   * @param handler Обработчик пакетов.
+   * @return Количество переданных пакетов.
+   */
+  static size_t parsePackets(const byte* data, size_t length, const timespec& now,
+      const ::std::shared_ptr<const void>& holder, const PacketHandler& handler) noexcept;
+
+ private:
+  static constexpr size_t kMaxMessageSize{0x10000 + 0x1000}; ///< Пакет до 64 КиБ и заголовки netlink
+
+  bool sendMessage(const ::std::vector<byte>& message, bool wait_ack) noexcept;
+
+  int fd_{-1}; ///< Сокет netlink
+  uint16_t queue_number_{0}; ///< Номер привязанной очереди
+  Config config_; ///< Параметры очереди
+  uint32_t sequence_{0}; ///< Номер последнего отправленного запроса
+  ::std::shared_ptr<::std::vector<byte>> buffer_; ///< Буфер пачки, разделяемый с выданными пакетами
+};
+
+
+}  // namespace flow_inspector::internal
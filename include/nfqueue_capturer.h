@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "netfilter_queue.h"
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class NfqueueCapturer : public PacketOrigin {
+ public:
+  struct Config {
+    ::std::vector<uint16_t> queues{0};
+    internal::NetfilterQueue::Config queue;
+  };
+
+  void setNfqueueConfig(const Config& config) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  bool hasOwnWorkers() const noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  ::std::string getStatistics() noexcept override;
+
+ private:
+  static constexpr int kPollTimeoutMs{100};
+  static constexpr uint64_t kSaturationPercent{75};
+
+  void readQueue(internal::NetfilterQueue& queue, const ::std::atomic<bool>& saturated) noexcept;
+
+  void updateStatistics(const ::std::vector<::std::unique_ptr<internal::NetfilterQueue>>& queues,
+      ::std::vector<::std::atomic<bool>>& saturated) noexcept;
+
+  Config config_;
+  ::std::atomic<uint32_t> copy_range_{0};
+  ::std::atomic<uint64_t> accepted_count_{0};
+  ::std::atomic<uint64_t> dropped_count_{0};
+  ::std::atomic<uint64_t> bypassed_count_{0};
+};
+
+
+}  // namespace flow_inspector
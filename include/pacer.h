@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class Pacer
+ * @brief Выдерживает заданный темп отправки пакетов относительно момента старта.
+ *
+ * Длинные паузы выдерживаются сном, а последний короткий отрезок перед целевым
+ * моментом - активным ожиданием, так как точность сна ограничена планировщиком.
+ */
+class Pacer {
+ public:
+  using Clock = ::std::chrono::steady_clock;
+
+  /**
+   * @brief Запоминает момент старта, от которого отсчитываются смещения.
+   */
+  void start() noexcept;
+
+  /**
+   * @brief Ожидает, пока с момента старта не пройдет указанное время.
+   * @param offset Смещение целевого момента от момента старта.
+   */
+  void waitUntil(::std::chrono::nanoseconds offset) const noexcept;
+
+  /**
+   * @brief Возвращает время, прошедшее с момента старта.
+   * @return Прошедшее время.
+   */
+  ::std::chrono::nanoseconds elapsed() const noexcept;
+
+  /**
+   * @brief Вычисляет момент отправки события при постоянном темпе.
+   * @param count Количество уже отправленных событий.
+   * @param per_second Темп в событиях в секунду, больше нуля.
+   * @return Смещение от момента старта, без переполнения на длинных прогонах.
+   */
+  static ::std::chrono::nanoseconds offsetAtRate(uint64_t count, uint64_t per_second) noexcept;
+
+ private:
+  static constexpr ::std::chrono::microseconds kSpinThreshold{200}; ///< Отрезок активного ожидания
+
+  Clock::time_point start_{Clock::now()}; ///< Момент старта
+};
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @struct PacketBlueprint
+ * @brief Описание синтетического пакета, из которого собирается Ethernet/IPv4 кадр
+ *
+ * Сигнатуры заполняют описание так, чтобы собранный кадр им удовлетворял.
+ */
+struct PacketBlueprint {
+  /**
+   * @enum Transport
+   * @brief Транспортный протокол пакета
+   */
+  enum class Transport {
+    TCP,
+    UDP,
+    ICMP,
+  };
+
+  ::std::optional<Transport> transport; ///< Транспорт; не задан, если сигнатуры его не ограничивают
+  uint32_t src_ip{0}; ///< IP-адрес источника в порядке байтов машины
+  uint32_t dst_ip{0}; ///< IP-адрес назначения в порядке байтов машины
+  uint16_t src_port{0}; ///< Порт источника
+  uint16_t dst_port{0}; ///< Порт назначения
+  ::std::vector<byte> payload; ///< Полезная нагрузка транспортного уровня
+  ::std::vector<::std::pair<uint32_t, ::std::vector<byte>>> raw_bytes; ///< Байты по смещениям от начала кадра
+
+  /**
+   * @brief Возвращает суммарный размер заголовков кадра до полезной нагрузки.
+   * @return Размер заголовков в байтах.
+   */
+  size_t headersSize() const noexcept;
+};
+
+
+/**
+ * @brief Собирает Ethernet/IPv4 кадр по описанию.
+ * @param blueprint Описание пакета. Незаданный транспорт считается TCP.
+ * @param frame_size Желаемый размер кадра; нагрузка дополняется заполнителем, но не обрезается.
+ * @param filler Байт заполнителя нагрузки.
+ * @return Кадр.
+ */
+::std::vector<byte> buildFrame(
+    const PacketBlueprint& blueprint, size_t frame_size = 0, byte filler = 0) noexcept;
+
+
+}  // namespace flow_inspector::internal
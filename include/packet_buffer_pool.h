@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ObjectPool.h"
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "packet_memory.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class PacketBufferPool
+ * @brief Пул заранее выделенных буферов кадров и оболочек сырых пакетов pcpp.
+ *
+ * Каждый поток, создающий пакеты, получает собственный пул, поэтому выдача идет без
+ * конкуренции, а возврат может происходить из любого потока: пакет держит свой пул
+ * и возвращает в него буфер и оболочку при уничтожении. Когда пул пуст, пакет
+ * выделяет память в куче, как и без пула, и это учитывается в счетчиках.
+ */
+class PacketBufferPool {
+ public:
+  /**
+   * @struct Config
+   * @brief Размеры пула одного потока
+   */
+  struct Config {
+    size_t buffer_size{2048}; ///< Размер буфера кадра, округляется до кэш-линии
+    size_t buffer_count{4096}; ///< Количество буферов, 0 отключает пулы
+    size_t shell_count{4096}; ///< Сколько оболочек сырых пакетов pcpp пул хранит для повторного использования
+    PacketMemory::Config memory; ///< Huge pages и закрепление памяти буферов
+  };
+
+  /**
+   * @struct Statistics
+   * @brief Счетчики пула
+   */
+  struct Statistics {
+    uint64_t buffers{0}; ///< Количество буферов в пуле
+    uint64_t buffers_in_use{0}; ///< Количество буферов, занятых пакетами
+    uint64_t exhausted{0}; ///< Кадры, скопированные в кучу, потому что свободных буферов не было
+    uint64_t oversized{0}; ///< Кадры, скопированные в кучу, потому что не помещались в буфер
+  };
+
+  /**
+   * @struct Slot
+   * @brief Буфер кадра вместе с оболочкой сырого пакета, указывающей на него
+   */
+  struct Slot {
+    byte* buffer{nullptr}; ///< Буфер кадра
+    ::pcpp::RawPacket* raw_packet{nullptr}; ///< Оболочка сырого пакета
+  };
+
+  /**
+   * @brief Создает пул и выделяет все его буферы одним отображением, при возможности на huge pages.
+   * @param config Размеры пула.
+   */
+  explicit PacketBufferPool(const Config& config) noexcept;
+
+  ~PacketBufferPool() noexcept;
+
+  PacketBufferPool(const PacketBufferPool&) = delete;
+  PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+  /**
+   * @brief Выдает свободный буфер с оболочкой сырого пакета.
+   * @param length Длина кадра, который будет скопирован в буфер.
+   * @param slot Выданный слот.
+   * @return false если кадр длиннее буфера или свободных буферов нет, причина учитывается в счетчиках.
+   */
+  bool acquireSlot(size_t length, Slot& slot) noexcept;
+
+  /**
+   * @brief Возвращает слот в пул.
+   * @param slot Слот, выданный acquireSlot.
+   */
+  void releaseSlot(const Slot& slot) noexcept;
+
+  /**
+   * @brief Возвращает в пул буфер слота, оболочка которого возвращена отдельно через releaseRawPacket.
+   * @param buffer Буфер, выданный acquireSlot.
+   */
+  void releaseBuffer(byte* buffer) noexcept;
+
+  /**
+   * @brief Выдает оболочку сырого пакета для кадра во внешнем буфере.
+   * @return Оболочка без данных.
+   */
+  ::std::unique_ptr<::pcpp::RawPacket> acquireRawPacket() noexcept;
+
+  /**
+   * @brief Возвращает оболочку сырого пакета в пул.
+   * @param raw_packet Оболочка, выданная acquireRawPacket.
+   */
+  void releaseRawPacket(::std::unique_ptr<::pcpp::RawPacket> raw_packet) noexcept;
+
+  /**
+   * @brief Возвращает счетчики пула.
+   * @return Счетчики пула.
+   */
+  Statistics getStatistics() const noexcept;
+
+  /**
+   * @brief Возвращает пул текущего потока, создавая его при первом обращении.
+   * @return Пул потока или nullptr, если пулы отключены.
+   */
+  static const ::std::shared_ptr<PacketBufferPool>& getThreadPool() noexcept;
+
+  /**
+   * @brief Задает размеры пулов, которые будут созданы потоками после вызова.
+   * @param config Размеры пула одного потока.
+   */
+  static void setThreadPoolConfig(const Config& config) noexcept;
+
+  /**
+   * @brief Суммирует счетчики всех пулов потоков, включая пулы завершившихся потоков.
+   * @return Суммарные счетчики.
+   */
+  static Statistics getTotalStatistics() noexcept;
+
+ private:
+  static constexpr size_t kCacheLineSize{64};
+
+  size_t buffer_size_; ///< Размер буфера с учетом выравнивания
+  size_t buffer_count_; ///< Количество буферов
+  PacketMemory memory_; ///< Отображение со всеми буферами, выровненное по странице
+  mutable ::std::mutex slots_mutex_; ///< Защищает список свободных слотов
+  ::std::vector<Slot> free_slots_; ///< Свободные слоты
+  ::pcpp::internal::DynamicObjectPool<::pcpp::RawPacket> raw_packets_; ///< Оболочки для внешних буферов
+  ::std::atomic<uint64_t> exhausted_{0}; ///< Кадры, не получившие буфер из-за пустого пула
+  ::std::atomic<uint64_t> oversized_{0}; ///< Кадры, не поместившиеся в буфер
+};
+
+
+}  // namespace flow_inspector::internal
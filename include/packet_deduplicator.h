@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class PacketDeduplicator
+ * @brief Отбрасывает повторные копии пакетов, которые приходят с SPAN-портов.
+ *
+ * Для каждого пакета считается хеш неизменяемых при зеркалировании полей: идентификатора
+ * и адресов IP, заголовка L4 (порты, номера последовательности) и начала полезной нагрузки.
+ * TTL, контрольная сумма IP и VLAN-метки в хеш не входят. Хеши хранятся в таблице
+ * фиксированного размера без блокировок вместе с временем пакета, и пакет считается
+ * повтором, если такой же хеш встречался не раньше чем окно назад.
+ */
+class PacketDeduplicator {
+ public:
+  /**
+   * @struct Config
+   * @brief Параметры дедупликации
+   */
+  struct Config {
+    uint32_t window_ms{10}; ///< Окно, в течение которого совпадающий пакет считается повтором
+    size_t table_size{1u << 16}; ///< Количество ячеек таблицы, округляется вверх до степени двойки
+    size_t prefix_length{128}; ///< Сколько байт после IP-заголовка входит в хеш
+  };
+
+  /**
+   * @brief Создает пустую таблицу.
+   * @param config Параметры дедупликации.
+   */
+  explicit PacketDeduplicator(const Config& config) noexcept;
+
+  /**
+   * @brief Проверяет пакет и запоминает его.
+   * @param packet Проверяемый пакет.
+   * @return true если такой же пакет уже встречался в пределах окна.
+   *
+   * Метод можно вызывать из нескольких потоков одновременно. При гонке за одну ячейку
+   * запись одного из потоков теряется, что может пропустить повтор, но не отбросить новый пакет.
+   */
+  bool isDuplicate(const Packet& packet) noexcept;
+
+  /**
+   * @brief Убирает повторы из пачки, сдвигая оставшиеся пакеты к ее началу.
+   * @param packets Пачка пакетов.
+   * @return Количество оставшихся пакетов.
+   */
+  size_t removeDuplicates(::std::span<Packet> packets) noexcept;
+
+  /**
+   * @brief Возвращает количество отброшенных повторов.
+   * @return Количество повторов с момента создания.
+   */
+  uint64_t getDuplicatesCount() const noexcept;
+
+  /**
+   * @brief Считает хеш неизменяемых полей кадра.
+   * @param data Данные кадра.
+   * @param length Длина кадра.
+   * @param link_type Тип канального уровня.
+   * @param prefix_length Сколько байт после IP-заголовка входит в хеш.
+   * @return Хеш кадра. Кадры, которые не удалось разобрать, хешируются целиком.
+   */
+  static uint64_t computeHash(const byte* data, size_t length,
+      ::pcpp::LinkLayerType link_type, size_t prefix_length) noexcept;
+
+ private:
+  static constexpr size_t kBucketSize{4}; ///< Количество ячеек, просматриваемых для одного хеша
+  static constexpr uint32_t kTickBits{24}; ///< Разрядность времени записи в миллисекундах
+  static constexpr uint64_t kTickMask{(uint64_t{1} << kTickBits) - 1};
+
+  Config config_; ///< Параметры дедупликации
+  size_t mask_; ///< Маска индекса ячейки
+  ::std::unique_ptr<::std::atomic<uint64_t>[]> slots_; ///< Ячейки: отпечаток хеша и время записи
+  ::std::atomic<uint64_t> duplicates_count_{0}; ///< Количество отброшенных повторов
+};
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class PacketMemory
+ * @brief Анонимное отображение памяти под данные пакетов, при возможности на huge pages и закрепленное в RAM.
+ *
+ * Явные huge pages (MAP_HUGETLB) выделяются из заранее зарезервированного системой пула. Если его нет
+ * или он исчерпан, память отображается обычными страницами с просьбой к ядру собрать их
+ * в прозрачные huge pages. Закрепление через mlock гарантирует, что обращения к данным пакетов
+ * не вызовут отказов страниц; при нехватке RLIMIT_MEMLOCK память остается незакрепленной.
+ * Отображение меньше половины 1G страницы размещается на 2M страницах, чтобы не занимать страницу целиком.
+ */
+class PacketMemory {
+ public:
+  static constexpr size_t kHugePageSize2M{size_t{1} << 21};
+  static constexpr size_t kHugePageSize1G{size_t{1} << 30};
+
+  /**
+   * @struct Config
+   * @brief Способ выделения памяти
+   */
+  struct Config {
+    size_t huge_page_size{0}; ///< Размер явных huge pages (kHugePageSize2M или kHugePageSize1G), 0 для обычных страниц
+    bool lock{false}; ///< Закрепить память в RAM и заполнить ее страницы сразу
+  };
+
+  PacketMemory() noexcept;
+
+  /**
+   * @brief Деструктор. Освобождает отображение.
+   */
+  ~PacketMemory() noexcept;
+
+  PacketMemory(const PacketMemory&) = delete;
+  PacketMemory& operator=(const PacketMemory&) = delete;
+
+  /**
+   * @brief Отображает память, заменяя предыдущее отображение.
+   * @param size Требуемый размер в байтах, округляется до размера страницы.
+   * @param config Способ выделения.
+   * @return false если память не удалось отобразить даже обычными страницами.
+   */
+  bool allocate(size_t size, const Config& config) noexcept;
+
+  /**
+   * @brief Освобождает отображение.
+   */
+  void release() noexcept;
+
+  /**
+   * @brief Возвращает начало отображения, выровненное по странице.
+   * @return Указатель на память или nullptr, если она не выделена.
+   */
+  byte* data() const noexcept;
+
+  /**
+   * @brief Возвращает размер отображения.
+   * @return Размер в байтах с учетом округления.
+   */
+  size_t size() const noexcept;
+
+  /**
+   * @brief Проверяет, выделена ли память явными huge pages.
+   * @return true если сработал MAP_HUGETLB.
+   */
+  bool isHuge() const noexcept;
+
+  /**
+   * @brief Проверяет, закреплена ли память в RAM.
+   * @return true если mlock выполнен успешно.
+   */
+  bool isLocked() const noexcept;
+
+ private:
+  byte* data_{nullptr}; ///< Начало отображения
+  size_t size_{0}; ///< Размер отображения
+  bool huge_{false}; ///< Память выделена явными huge pages
+  bool locked_{false}; ///< Память закреплена через mlock
+};
+
+
+}  // namespace flow_inspector::internal
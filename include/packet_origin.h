@@ -2,10 +2,17 @@
 
 #include <functional>
 #include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <pcap.h>
 
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 
 
 namespace flow_inspector {
@@ -15,26 +22,73 @@ class PacketOrigin {
  public:
   using PacketProcessor = ::std::function<void(internal::Packet)>;
 
+  using BatchProcessor = ::std::function<void(::std::span<internal::Packet>)>;
+
+  struct CaptureStatistics {
+    uint64_t received{0};
+    uint64_t kernel_drops{0};
+    uint64_t interface_drops{0};
+    uint64_t stalls{0};
+  };
+
   void setProcessor(PacketProcessor processor) noexcept;
 
   void processPacket(const ::pcpp::RawPacket& packet) noexcept;
 
+  void processPacket(internal::Packet packet) noexcept;
+
+  void setBatchProcessor(BatchProcessor processor) noexcept;
+
+  void processPackets(::std::span<internal::Packet> packets) noexcept;
+
   virtual void startReading() noexcept = 0;
 
   virtual ::pcpp::LinkLayerType getLinkLayerType() noexcept = 0;
 
   void stopReading() noexcept;
 
+  virtual bool hasOwnWorkers() const noexcept;
+
+  virtual ::std::string getStatistics() noexcept;
+
+  bool getCaptureStatistics(CaptureStatistics& statistics) noexcept;
+
+  void setCaptureFilter(const ::std::string& filter) noexcept;
+
+  void setSnapshotLength(uint32_t snapshot_length) noexcept;
+
+  virtual void setRuleBlueprints(::std::vector<internal::PacketBlueprint> blueprints) noexcept;
+
   bool isDoneReading() const noexcept;
 
+  bool hasFailed() const noexcept;
+
   virtual ~PacketOrigin() = default;
 
  protected:
+  static constexpr size_t kBatchSize{256};
+
   virtual void internalStopReading() noexcept = 0;
 
+  void flushBatch(::std::vector<internal::Packet>& batch) noexcept;
+
+  bool takeCaptureFilter(::std::string& filter, uint32_t& snapshot_length) noexcept;
+
+  void setCaptureStatistics(const CaptureStatistics& statistics) noexcept;
+
+  void markFailed() noexcept;
+
  private:
   PacketProcessor packet_processor_;
+  BatchProcessor batch_processor_;
   ::std::atomic<bool> done_;
+  ::std::atomic<bool> failed_{false};
+  ::std::mutex capture_filter_mutex_;
+  ::std::string capture_filter_;
+  uint32_t snapshot_length_{0};
+  ::std::atomic<bool> capture_filter_changed_{false};
+  ::std::mutex capture_statistics_mutex_;
+  ::std::optional<CaptureStatistics> capture_statistics_;
 };
 
 
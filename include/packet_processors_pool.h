@@ -1,7 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <thread>
+#include <vector>
 
 #include "analyzer.h"
 #include "concurrentqueue.h"
@@ -18,9 +23,19 @@ class PacketProcessorsPool {
 
   void addCallback(Callback callback) noexcept;
 
+  void setMaxQueueDepth(size_t max_queue_depth) noexcept;
+
   void addPacket(internal::Packet packet) noexcept;
 
-  bool getPacket(internal::Packet& result) noexcept;
+  void addPackets(::std::span<internal::Packet> packets) noexcept;
+
+  size_t getQueueDepth() const noexcept;
+
+  uint64_t getDroppedCount() const noexcept;
+
+  void analyzePacket(internal::Packet& packet) noexcept;
+
+  void analyzePackets(::std::span<internal::Packet> packets) noexcept;
 
   ~PacketProcessorsPool() noexcept;
 
@@ -28,16 +43,28 @@ class PacketProcessorsPool {
 
  private:
   static constexpr ::std::chrono::milliseconds kSleepTime{10};
+  static constexpr size_t kMaxBatchSize{256};
 
   void processPacket() noexcept;
 
+  size_t getPackets(::moodycamel::ConsumerToken& token, ::std::span<internal::Packet> batch) noexcept;
+
+  size_t acceptedCount(size_t count) noexcept;
+
+  ::moodycamel::ProducerToken& getProducerToken() noexcept;
+
   ::moodycamel::ConcurrentQueue<internal::Packet> packets_;
+  const uint64_t id_;
+  ::std::mutex producer_tokens_mutex_;
+  ::std::vector<::std::unique_ptr<::moodycamel::ProducerToken>> producer_tokens_;
 
   ::std::vector<::std::thread> processors_;
   ::std::vector<Callback> callbacks_;
 
   Analyzer& analyzer_;
   ::std::atomic<bool> done_{false};
+  ::std::atomic<size_t> max_queue_depth_{0};
+  ::std::atomic<uint64_t> dropped_count_{0};
 };
 
 
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class PacketRing
+ * @brief Кольцевой буфер TPACKET_V3 сокета AF_PACKET, отображенный в память процесса.
+ *
+ * Ядро складывает кадры в блоки кольца, а пакеты выдаются наружу без копирования:
+ * каждый пакет ссылается на свой блок, и блок возвращается ядру только после того,
+ * как освобождены все пакеты из него. Отображение живет, пока жив хотя бы один пакет.
+ */
+class PacketRing {
+ public:
+  using PacketHandler = ::std::function<void(Packet)>;
+
+  /**
+   * @struct Config
+   * @brief Геометрия кольца
+   */
+  struct Config {
+    uint32_t block_size{1u << 22}; ///< Размер блока в байтах, кратен размеру страницы
+    uint32_t block_count{64}; ///< Количество блоков в кольце
+    uint32_t frame_size{2048}; ///< Размер слота кадра, используется ядром для проверки геометрии
+    uint32_t retire_timeout_ms{60}; ///< Время, после которого неполный блок отдается пользователю
+  };
+
+  /**
+   * @struct Statistics
+   * @brief Счетчики сокета кольца с момента открытия
+   */
+  struct Statistics {
+    uint64_t packets{0}; ///< Пакеты, дошедшие до сокета, включая отброшенные
+    uint64_t drops{0}; ///< Пакеты, отброшенные ядром из-за переполнения кольца
+    uint64_t stalls{0}; ///< Ожидания блока, который обработчики еще не отпустили
+  };
+
+  PacketRing() noexcept;
+
+  /**
+   * @brief Деструктор. Закрывает кольцо, если оно открыто.
+   */
+  ~PacketRing() noexcept;
+
+  PacketRing(const PacketRing&) = delete;
+  PacketRing& operator=(const PacketRing&) = delete;
+
+  /**
+   * @brief Создает сокет, кольцо и привязывает их к интерфейсу.
+   * @param interface_name Имя сетевого интерфейса.
+   * @param config Геометрия кольца.
+   * @return true в случае успеха, false при ошибке.
+   */
+  bool open(const ::std::string& interface_name, const Config& config) noexcept;
+
+  /**
+   * @brief Включает сокет кольца в fanout-группу, между сокетами которой ядро делит трафик.
+   * @param group_id Идентификатор группы, общий для всех сокетов группы.
+   * @param mode Режим распределения (PACKET_FANOUT_HASH, PACKET_FANOUT_CPU и т.д.).
+   * @return true в случае успеха, false при ошибке.
+   */
+  bool joinFanout(uint16_t group_id, uint16_t mode) noexcept;
+
+  /**
+   * @brief Устанавливает на сокет кольца BPF-фильтр, отбрасывающий пакеты еще в ядре.
+   * @param filter Выражение в синтаксисе pcap-filter. Пустая строка пропускает все пакеты.
+   * @param snapshot_length Сколько байт кадра сохранять в кольце, 0 для кадров целиком.
+   * @return true в случае успеха, false если выражение не компилируется или ядро его не приняло.
+   *
+   * Длина среза задается значением, которое возвращает BPF-программа для принятого пакета,
+   * поэтому без фильтра и среза программа снимается с сокета целиком.
+   */
+  bool setFilter(const ::std::string& filter, uint32_t snapshot_length = 0) noexcept;
+
+  /**
+   * @brief Отпускает кольцо. Память освобождается, когда будут отпущены все выданные пакеты.
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Проверяет, открыто ли кольцо.
+   * @return true если кольцо открыто.
+   */
+  bool isOpen() const noexcept;
+
+  /**
+   * @brief Ожидает очередной заполненный блок и передает его кадры обработчику.
+   * @param timeout_ms Максимальное время ожидания блока в миллисекундах.
+   * @param handler Обработчик пакетов блока.
+   * @return false при ошибке сокета, иначе true (в том числе по таймауту).
+   *
+   * Если очередной блок с прошлого круга еще не отпущен обработчиками, метод ждет его освобождения
+   * не дольше timeout_ms и учитывает ожидание в счетчике stalls.
+   */
+  bool readBlock(int timeout_ms, const PacketHandler& handler) noexcept;
+
+  /**
+   * @brief Передает обработчику кадры заполненного блока TPACKET_V3.
+   * @param block Начало блока (tpacket_block_desc).
+   * @param link_type Тип канального уровня кадров.
+   * @param holder Владелец блока, который получает каждый пакет.
+   * @param handler Обработчик пакетов блока.
+   * @return Количество переданных кадров.
+   */
+  static uint32_t readFrames(const byte* block, ::pcpp::LinkLayerType link_type,
+      const ::std::shared_ptr<const void>& holder, const PacketHandler& handler) noexcept;
+
+  /**
+   * @brief Возвращает счетчики сокета кольца.
+   * @return Накопленные с момента открытия кольца счетчики.
+   *
+   * Ядро обнуляет счетчики при каждом чтении, поэтому кольцо накапливает их само,
+   * в том числе при закрытии. Метод нельзя вызывать одновременно с open и close.
+   */
+  Statistics getStatistics() noexcept;
+
+  /**
+   * @brief Возвращает тип канального уровня кадров кольца.
+   * @return Тип канального уровня.
+   */
+  ::pcpp::LinkLayerType getLinkLayerType() const noexcept;
+
+  /**
+   * @brief Определяет тип канального уровня интерфейса по его аппаратному типу.
+   * @param interface_name Имя сетевого интерфейса.
+   * @return Тип канального уровня кадров, которые отдает сокет AF_PACKET.
+   */
+  static ::pcpp::LinkLayerType queryLinkLayerType(const ::std::string& interface_name) noexcept;
+
+ private:
+  static constexpr int kMaxFrameLength{262144};
+
+  struct Mapping;
+
+  ::std::shared_ptr<Mapping> mapping_; ///< Сокет и отображенная память кольца
+  uint32_t current_block_{0}; ///< Индекс блока, который будет прочитан следующим
+  Statistics statistics_; ///< Счетчики, накопленные с момента открытия
+  ::pcpp::LinkLayerType link_type_{::pcpp::LinkLayerType::LINKTYPE_ETHERNET}; ///< Тип канального уровня
+};
+
+
+}  // namespace flow_inspector::internal
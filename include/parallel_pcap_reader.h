@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class ParallelPcapReader : public PacketOrigin {
+ public:
+  void setFilename(const ::std::string& filename) noexcept;
+
+  void setWorkersCount(uint8_t workers_count) noexcept;
+
+  void setChunkSize(size_t packets_count) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  bool hasOwnWorkers() const noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+ private:
+  static constexpr size_t kDefaultChunkPackets{4096};
+
+  ::std::string input_file_;
+  uint8_t workers_count_{1};
+  size_t chunk_packets_{kDefaultChunkPackets};
+};
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+constexpr size_t kPcapFileHeaderSize{24}; ///< Размер заголовка pcap-файла
+constexpr size_t kPcapRecordHeaderSize{16}; ///< Размер заголовка записи pcap-файла
+
+
+/**
+ * @struct PcapFileInfo
+ * @brief Параметры pcap-файла, прочитанные из его заголовка
+ */
+struct PcapFileInfo {
+  bool swapped{false}; ///< Порядок байтов файла отличается от порядка байтов машины
+  bool nanosecond{false}; ///< Временные метки записаны с наносекундной точностью
+  uint32_t snapshot_length{0}; ///< Максимальная длина сохраненного кадра
+  ::pcpp::LinkLayerType link_type{::pcpp::LinkLayerType::LINKTYPE_ETHERNET}; ///< Тип канального уровня
+};
+
+
+/**
+ * @struct PcapRecord
+ * @brief Запись pcap-файла, указывающая на данные кадра внутри буфера файла
+ */
+struct PcapRecord {
+  timespec timestamp{}; ///< Временная метка кадра
+  uint32_t captured_length{0}; ///< Количество сохраненных байтов кадра
+  uint32_t original_length{0}; ///< Исходная длина кадра
+  const byte* data{nullptr}; ///< Данные кадра
+};
+
+
+/**
+ * @struct MappedPcapFile
+ * @brief pcap-файл, отображенный в память только для чтения
+ *
+ * Отображение снимается в деструкторе, поэтому пакеты, ссылающиеся на файл,
+ * должны разделять владение этой структурой.
+ */
+struct MappedPcapFile {
+  const byte* data{nullptr}; ///< Начало файла
+  size_t size{0}; ///< Размер файла
+  PcapFileInfo info; ///< Параметры файла
+
+  ~MappedPcapFile() noexcept;
+};
+
+
+/**
+ * @brief Разбирает заголовок классического pcap-файла.
+ * @param data Начало файла.
+ * @param size Количество доступных байтов.
+ * @param info Результат разбора.
+ * @return true если заголовок корректен, false для pcapng и прочих форматов.
+ */
+bool parsePcapFileHeader(const byte* data, size_t size, PcapFileInfo& info) noexcept;
+
+
+/**
+ * @brief Разбирает очередную запись pcap-файла.
+ * @param data Начало записи.
+ * @param size Количество доступных байтов.
+ * @param info Параметры файла.
+ * @param record Результат разбора.
+ * @return Размер записи вместе с заголовком или 0, если запись неполная или повреждена.
+ */
+size_t parsePcapRecord(
+    const byte* data, size_t size, const PcapFileInfo& info, PcapRecord& record) noexcept;
+
+
+/**
+ * @brief Читает и разбирает заголовок pcap-файла.
+ * @param filename Путь к файлу.
+ * @param info Результат разбора.
+ * @return true в случае успеха, false если файл не открылся или его формат не поддерживается.
+ */
+bool readPcapFileInfo(const ::std::string& filename, PcapFileInfo& info) noexcept;
+
+
+/**
+ * @brief Отображает pcap-файл в память и разбирает его заголовок.
+ * @param filename Путь к файлу.
+ * @return Отображение файла или nullptr, если файл не открылся или его формат не поддерживается.
+ */
+::std::shared_ptr<MappedPcapFile> mapPcapFile(const ::std::string& filename) noexcept;
+
+
+}  // namespace flow_inspector::internal
@@ -28,6 +28,12 @@ class RawBytesSignature: public Signature {
 
   size_t hash() const noexcept override;
 
+  bool fillBlueprint(PacketBlueprint& blueprint) const noexcept override;
+
+  size_t getInspectedLength() const noexcept override;
+
+  bool usesHeaders() const noexcept override;
+
   // parses the rules that satisfy the following pattern
   // event; name; signature1; signature2 ...
   // where event is a member of ::flow_inspector::internal::Event::EventType
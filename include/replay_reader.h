@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "pacer.h"
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class ReplayReader : public PacketOrigin {
+ public:
+  struct Config {
+    double speed{1.0};
+    uint64_t target_pps{0};
+    double target_mbps{0};
+    size_t loops{1};
+  };
+
+  void setFilename(const ::std::string& filename) noexcept;
+
+  void setReplayConfig(const Config& config) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  ::std::string getStatistics() noexcept override;
+
+ private:
+  ::std::string describeRate(::std::chrono::nanoseconds elapsed) const noexcept;
+
+  ::std::string describeTarget() const noexcept;
+
+  ::std::string input_file_;
+  Config config_;
+  internal::Pacer pacer_;
+  ::std::atomic<bool> started_{false};
+  ::std::atomic<uint64_t> replayed_packets_{0};
+  ::std::atomic<uint64_t> replayed_bytes_{0};
+};
+
+
+}  // namespace flow_inspector
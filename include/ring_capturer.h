@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "packet_origin.h"
+#include "packet_ring.h"
+
+
+namespace flow_inspector {
+
+
+class RingCapturer : public PacketOrigin {
+ public:
+  void setInterfaceName(const ::std::string& interface_name) noexcept;
+
+  void setRingConfig(const internal::PacketRing::Config& config) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+ private:
+  static constexpr int kPollTimeoutMs{100};
+  static constexpr ::std::chrono::milliseconds kStatisticsInterval{100};
+
+  void updateStatistics() noexcept;
+
+  ::std::string interface_name_;
+  internal::PacketRing::Config config_;
+  internal::PacketRing ring_;
+};
+
+
+}  // namespace flow_inspector
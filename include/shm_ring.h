@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+/**
+ * @class ShmRing
+ * @brief Кольцо пакетов в разделяемой памяти /dev/shm с одним писателем и одним читателем.
+ *
+ * Кольцо состоит из заголовка, массива дескрипторов и массива слабов данных фиксированного
+ * размера, по одному слабу на дескриптор. Писатель (внешний процесс захвата) продвигает голову,
+ * читатель выдает пакеты прямо из слабов и продвигает хвост, когда отпущены все пакеты пачки.
+ * Обмен идет только через атомарные счетчики в общей памяти, без системных вызовов на пакет.
+ */
+class ShmRing {
+ public:
+  using PacketHandler = ::std::function<void(Packet)>;
+
+  /**
+   * @struct Config
+   * @brief Геометрия кольца, задается писателем при создании
+   */
+  struct Config {
+    uint32_t slot_count{1u << 16}; ///< Количество слотов, степень двойки
+    uint32_t slab_size{2048}; ///< Размер слаба данных, более длинные кадры обрезаются
+  };
+
+  ShmRing() noexcept;
+
+  /**
+   * @brief Деструктор. Закрывает кольцо, если оно открыто.
+   */
+  ~ShmRing() noexcept;
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  /**
+   * @brief Создает кольцо на стороне писателя, заменяя существующее с тем же именем.
+   * @param name Имя объекта разделяемой памяти, например "/flow_inspector".
+   * @param config Геометрия кольца.
+   * @param link_type Тип канального уровня кадров.
+   * @return true в случае успеха, false при ошибке.
+   */
+  bool create(const ::std::string& name, const Config& config, ::pcpp::LinkLayerType link_type) noexcept;
+
+  /**
+   * @brief Подключается к кольцу, созданному писателем.
+   * @param name Имя объекта разделяемой памяти.
+   * @return true в случае успеха, false если кольца нет или его формат не поддерживается.
+   */
+  bool attach(const ::std::string& name) noexcept;
+
+  /**
+   * @brief Закрепляет отображение кольца в RAM, чтобы чтение кадров не вызывало отказов страниц.
+   * @return false если кольцо не открыто или не хватает RLIMIT_MEMLOCK.
+   */
+  bool lockMemory() noexcept;
+
+  /**
+   * @brief Отпускает кольцо. Писатель удаляет объект разделяемой памяти.
+   *
+   * Память читателя освобождается, когда будут отпущены все выданные пакеты.
+   */
+  void close() noexcept;
+
+  /**
+   * @brief Проверяет, открыто ли кольцо.
+   * @return true если кольцо открыто.
+   */
+  bool isOpen() const noexcept;
+
+  /**
+   * @brief Записывает кадр в очередной слот (только для писателя).
+   * @param data Данные кадра.
+   * @param length Количество байтов кадра, не более размера слаба сохраняется.
+   * @param original_length Исходная длина кадра.
+   * @param timestamp Временная метка кадра.
+   * @return false если кольцо заполнено, кадр при этом не записывается.
+   */
+  bool push(const byte* data, uint32_t length, uint32_t original_length, const timespec& timestamp) noexcept;
+
+  /**
+   * @brief Отмечает, что писатель больше не будет записывать кадры.
+   */
+  void finish() noexcept;
+
+  /**
+   * @brief Проверяет, что читатель отпустил все записанные кадры (только для писателя).
+   * @return true если в кольце нет занятых слотов.
+   */
+  bool isDrained() const noexcept;
+
+  /**
+   * @brief Выдает обработчику доступные кадры (только для читателя).
+   * @param max_packets Максимальное количество кадров за вызов.
+   * @param handler Обработчик пакетов.
+   * @return Количество выданных пакетов, 0 если новых кадров нет.
+   *
+   * Пакеты пачки разделяют владение ее слотами, слоты возвращаются писателю по порядку,
+   * когда отпущены все пакеты пачки и всех пачек перед ней.
+   */
+  size_t read(size_t max_packets, const PacketHandler& handler) noexcept;
+
+  /**
+   * @brief Возвращает писателю слоты отпущенных пачек (только для читателя).
+   * @return true если все выданные пачки отпущены.
+   *
+   * Вызывается из read, отдельно нужен только для того, чтобы дождаться последних пачек.
+   */
+  bool releaseBatches() noexcept;
+
+  /**
+   * @brief Проверяет, что писатель закончил работу и все его кадры выданы (только для читателя).
+   * @return true если новых кадров больше не будет.
+   */
+  bool isFinished() const noexcept;
+
+  /**
+   * @brief Возвращает тип канального уровня кадров кольца.
+   * @return Тип канального уровня.
+   */
+  ::pcpp::LinkLayerType getLinkLayerType() const noexcept;
+
+ private:
+  struct Header;
+  struct Descriptor;
+  struct Mapping;
+
+  /**
+   * @struct Batch
+   * @brief Выданная читателем пачка слотов
+   */
+  struct Batch {
+    uint64_t start{0}; ///< Номер первого слота пачки
+    uint64_t count{0}; ///< Количество слотов пачки
+  };
+
+  static size_t getMappingSize(const Config& config) noexcept;
+
+  bool map(int fd, size_t size) noexcept;
+
+  ::std::shared_ptr<Mapping> mapping_; ///< Отображение кольца
+  ::std::string name_; ///< Имя объекта, которое писатель удаляет при закрытии
+  bool producer_{false}; ///< Кольцо открыто писателем
+  uint64_t position_{0}; ///< Номер следующего слота для записи или чтения
+  ::std::deque<Batch> batches_; ///< Выданные читателем пачки, еще не возвращенные писателю
+};
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "packet_origin.h"
+#include "shm_ring.h"
+
+
+namespace flow_inspector {
+
+
+class ShmRingReader : public PacketOrigin {
+ public:
+  void setRingName(const ::std::string& ring_name) noexcept;
+
+  void setLockMemory(bool lock) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+ private:
+  static constexpr uint32_t kIdleSpins{64};
+  static constexpr ::std::chrono::microseconds kIdleSleep{50};
+  static constexpr ::std::chrono::milliseconds kStatisticsInterval{100};
+
+  bool attach() noexcept;
+
+  ::std::string ring_name_;
+  bool lock_memory_{false};
+  internal::ShmRing ring_;
+};
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <sys/types.h>
+
+#include "RawPacket.h"
+
+#include "packet_origin.h"
+#include "pcap_file_format.h"
+
+
+namespace flow_inspector {
+
+
+class StreamPcapReader : public PacketOrigin {
+ public:
+  ~StreamPcapReader() noexcept override;
+
+  void setFilename(const ::std::string& filename) noexcept;
+
+  void setBlockSize(size_t block_size) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  static bool isStream(const ::std::string& filename) noexcept;
+
+ private:
+  static constexpr size_t kMinBlockSize{1u << 20};
+  static constexpr size_t kDefaultBlockSize{1u << 24};
+  static constexpr int kPipeSize{1 << 20};
+  static constexpr int kPollTimeoutMs{100};
+
+  bool openStream() noexcept;
+
+  ssize_t readSome(internal::byte* data, size_t size) noexcept;
+
+  void closeStream() noexcept;
+
+  ::std::string input_file_;
+  size_t block_size_{kDefaultBlockSize};
+  int fd_{-1};
+  bool header_read_{false};
+  internal::PcapFileInfo info_;
+};
+
+
+}  // namespace flow_inspector
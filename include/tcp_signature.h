@@ -19,6 +19,12 @@ class TCPSignature : public Signature {
 
   size_t hash() const noexcept override;
 
+  ::std::string getCaptureFilter() const noexcept override;
+
+  bool fillBlueprint(PacketBlueprint& blueprint) const noexcept override;
+
+  size_t getInspectedLength() const noexcept override;
+
   static ::std::unique_ptr<Signature> createTCPSignature(const ::std::string& initString) noexcept;
 
  private:
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <PcapLiveDeviceList.h>
 #include <PcapLiveDevice.h>
@@ -13,24 +17,63 @@ namespace flow_inspector {
 
 class TrafficCapturer : public PacketOrigin {
  public:
+  struct Config {
+    bool promiscuous{true};
+    int buffer_size{0};
+    int buffer_timeout_ms{0};
+    ::pcpp::PcapLiveDevice::PcapDirection direction{::pcpp::PcapLiveDevice::PCPP_INOUT};
+    uint32_t snapshot_length{0};
+    bool auto_tune{false};
+    int max_buffer_size{256 << 20};
+  };
+
   TrafficCapturer() noexcept;
 
   ~TrafficCapturer() noexcept;
 
   void setInterfaceName(const ::std::string& interface_name) noexcept;
 
+  void setCaptureConfig(const Config& config) noexcept;
+
   void startReading() noexcept override;
 
   void internalStopReading() noexcept override;
 
   ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
 
+  static constexpr int kAutoTuneInitialBufferSize{2 << 20};
+
+  static int tuneBufferSize(uint64_t new_drops, int buffer_size, int max_buffer_size) noexcept;
+
  private:
+  static constexpr ::std::chrono::milliseconds kPollInterval{100};
+  static constexpr ::std::chrono::milliseconds kAutoTuneInterval{1000};
+
+  bool openDevice() noexcept;
+
+  void reopenDevice() noexcept;
+
+  void applyCaptureFilter() noexcept;
+
+  void autoTuneBuffer() noexcept;
+
+  void updateStatistics() noexcept;
+
+  void flushPackets() noexcept;
+
   static void onPacketArrives(
       ::pcpp::RawPacket* raw_packet, ::pcpp::PcapLiveDevice* dev, void* user_data) noexcept;
 
   ::std::string interface_name_;
   ::pcpp::PcapLiveDevice* device_;
+  ::std::string capture_filter_;
+  uint32_t snapshot_length_{0};
+  Config config_;
+  CaptureStatistics closed_statistics_;
+  uint64_t tuned_kernel_drops_{0};
+  ::std::chrono::steady_clock::time_point last_tune_;
+  ::std::mutex batch_mutex_;
+  ::std::vector<internal::Packet> batch_;
 };
 
 
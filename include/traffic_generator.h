@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "packet_blueprint.h"
+#include "packet_origin.h"
+
+
+namespace flow_inspector {
+
+
+class TrafficGenerator : public PacketOrigin {
+ public:
+  struct Config {
+    size_t flows{1024};
+    size_t min_size{64};
+    size_t max_size{1500};
+    ::std::string alphabet{"abcdefghijklmnopqrstuvwxyz0123456789"};
+    double hit_percent{0};
+    uint64_t seed{1};
+    uint64_t packets{0};
+    uint32_t tcp_weight{80};
+    uint32_t udp_weight{15};
+    uint32_t icmp_weight{5};
+    size_t pool_size{65536};
+  };
+
+  void setGeneratorConfig(const Config& config) noexcept;
+
+  void setWorkersCount(uint8_t workers_count) noexcept;
+
+  void setRuleBlueprints(::std::vector<internal::PacketBlueprint> blueprints) noexcept override;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  bool hasOwnWorkers() const noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  ::std::string getStatistics() noexcept override;
+
+ private:
+  struct FramePool {
+    ::std::vector<internal::byte> data;
+    ::std::vector<::std::pair<size_t, uint32_t>> frames;
+    size_t hits{0};
+  };
+
+  ::std::shared_ptr<const FramePool> buildPool() const noexcept;
+
+  void generate(const FramePool& pool, const ::std::shared_ptr<const void>& holder) noexcept;
+
+  ::std::string describeRate() const noexcept;
+
+  Config config_;
+  uint8_t workers_count_{1};
+  mutable ::std::mutex blueprints_mutex_;
+  ::std::vector<internal::PacketBlueprint> blueprints_;
+  ::std::chrono::steady_clock::time_point start_time_;
+  ::std::atomic<bool> started_{false};
+  ::std::atomic<uint64_t> claimed_packets_{0};
+  ::std::atomic<uint64_t> generated_packets_{0};
+  ::std::atomic<uint64_t> generated_bytes_{0};
+};
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "packet_origin.h"
+
+
+namespace pcpp {
+class RawPacket;
+class XdpDevice;
+}  // namespace pcpp
+
+
+namespace flow_inspector {
+
+
+class XdpCapturer : public PacketOrigin {
+ public:
+  enum class AttachMode {
+    Skb,
+    Driver,
+    Auto,
+  };
+
+  struct Config {
+    AttachMode attach_mode{AttachMode::Auto};
+    uint16_t umem_frames{4096};
+    uint32_t ring_size{2048};
+    uint16_t batch_size{64};
+  };
+
+  XdpCapturer() noexcept;
+
+  ~XdpCapturer() noexcept override;
+
+  void setInterfaceName(const ::std::string& interface_name) noexcept;
+
+  void setXdpConfig(const Config& config) noexcept;
+
+  void startReading() noexcept override;
+
+  void internalStopReading() noexcept override;
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override;
+
+  ::std::string getStatistics() noexcept override;
+
+  void receiveBatch(const ::pcpp::RawPacket packets[], uint32_t packets_count) noexcept;
+
+ private:
+  static constexpr int kPollTimeoutMs{100};
+
+  static void onPacketsArrive(
+      ::pcpp::RawPacket packets[], uint32_t packets_count, ::pcpp::XdpDevice* device, void* cookie);
+
+  void updateStatistics(::pcpp::XdpDevice& device, bool force) noexcept;
+
+  ::std::string interface_name_;
+  Config config_;
+  ::std::vector<internal::Packet> batch_;
+  ::std::chrono::steady_clock::time_point last_statistics_;
+  ::std::mutex statistics_mutex_;
+  ::std::string statistics_;
+};
+
+
+}  // namespace flow_inspector
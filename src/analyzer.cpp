@@ -1,17 +1,26 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
 #include <thread>
 #include <unordered_set>
 #include <shared_mutex>
 #include <mutex>
 #include <fstream>
+#include <vector>
 
 #include "analyzer.h"
 #include "debug_logger.h"
+#include "decapsulation.h"
 #include "ip_signature.h"
 #include "tcp_signature.h"
 #include "content_signature.h"
 #include "logger.h"
 #include "events_handler.h"
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 #include "raw_bytes_signature.h"
 #include "signature_factory.h"
 
@@ -37,8 +46,15 @@ void Analyzer::detectThreats(const internal::Packet& packet) noexcept {
   packets_count_.fetch_add(1);
   
   ::std::shared_lock<::std::shared_mutex> lock(rules_mutex_);
+  if (link_decoder_ && uses_headers_
+      && packet.packet->getLinkLayerType() == link_type_) {
+    packet.getView(link_decoder_);
+  }
   for (const auto&  rule : rules_) {
     if (rule.check(packet)) {
+      if (rule.getType() == internal::Event::EventType::Alert) {
+        packet.alerted = true;
+      }
       events_handler_.addEvent(internal::Event{
         .type = rule.getType(),
         .rule = rule,
@@ -68,6 +84,84 @@ void Analyzer::setStatSpeed(size_t interval) noexcept {
   stats_printer_ = ::std::thread{&Analyzer::printStats, this};
 }
 
+void Analyzer::setStatsSource(StatsSource source) noexcept {
+  stats_source_ = ::std::move(source);
+}
+
+::std::string Analyzer::getCaptureFilter() const noexcept {
+  ::std::shared_lock<::std::shared_mutex> lock(rules_mutex_);
+  ::std::set<::std::string> rule_filters;
+  for (const auto& rule : rules_) {
+    auto rule_filter = rule.getCaptureFilter();
+    if (rule_filter.empty()) {
+      return {};
+    }
+    rule_filters.insert(::std::move(rule_filter));
+  }
+  if (rule_filters.empty()) {
+    return {};
+  }
+
+  ::std::string filter;
+  for (const auto& rule_filter : rule_filters) {
+    filter += "(" + rule_filter + ") or ";
+  }
+  // Туннели снимаются при анализе, поэтому внешние заголовки туннеля фильтром не проверить.
+  // Ключевое слово vlan сдвигает смещения для всех последующих условий и должно идти последним,
+  // поэтому немаркированный MPLS проверяется по EtherType, а не ключевым словом mpls
+  return filter + "ip proto gre or ip6 proto gre or ip proto 4 or ip proto 41 or ip6 proto 4 or ip6 proto 41"
+      " or udp dst port 4789"
+      " or ether proto 0x8847 or ether proto 0x8848 or vlan";
+}
+
+bool Analyzer::usesHeaders() const noexcept {
+  ::std::shared_lock<::std::shared_mutex> lock(rules_mutex_);
+  return uses_headers_;
+}
+
+void Analyzer::setLinkLayerType(::pcpp::LinkLayerType link_type) noexcept {
+  ::std::unique_lock<::std::shared_mutex> lock(rules_mutex_);
+  link_type_ = link_type;
+  link_decoder_ = internal::selectLinkDecoder(link_type);
+}
+
+void Analyzer::updateUsesHeaders() noexcept {
+  uses_headers_ = false;
+  for (const auto& rule : rules_) {
+    uses_headers_ = uses_headers_ || rule.usesHeaders();
+  }
+}
+
+uint32_t Analyzer::getSnapshotLength() const noexcept {
+  ::std::shared_lock<::std::shared_mutex> lock(rules_mutex_);
+  size_t length = 0;
+  for (const auto& rule : rules_) {
+    const size_t rule_length = rule.getInspectedLength();
+    if (!rule_length) {
+      return 0;
+    }
+    length = ::std::max(length, rule_length);
+  }
+  return static_cast<uint32_t>(::std::min<size_t>(length, ::std::numeric_limits<uint32_t>::max()));
+}
+
+::std::vector<internal::PacketBlueprint> Analyzer::getRuleBlueprints() const noexcept {
+  ::std::shared_lock<::std::shared_mutex> lock(rules_mutex_);
+  ::std::map<::std::string, internal::PacketBlueprint> rule_blueprints;
+  for (const auto& rule : rules_) {
+    internal::PacketBlueprint blueprint;
+    if (rule.fillBlueprint(blueprint)) {
+      rule_blueprints.emplace(rule.getName(), ::std::move(blueprint));
+    }
+  }
+
+  ::std::vector<internal::PacketBlueprint> blueprints;
+  for (auto& [name, blueprint] : rule_blueprints) {
+    blueprints.push_back(::std::move(blueprint));
+  }
+  return blueprints;
+}
+
 bool Analyzer::updateRulesFromFile(const ::std::string& filename) noexcept {
   logger_.logMessage("Updating rules from file: " + filename);
   
@@ -86,6 +180,7 @@ bool Analyzer::updateRulesFromFile(const ::std::string& filename) noexcept {
   
   rules_ = ::std::move(new_rules);
   signatures_ = ::std::move(new_signatures);
+  updateUsesHeaders();
   
   logger_.logMessage("Rules successfully updated. Total rules: " + ::std::to_string(rules_.size()));
   return true;
@@ -192,12 +287,15 @@ bool Analyzer::parseRuleToContainer(
 
 bool Analyzer::tryParseNative(const ::std::string& rule) noexcept {
   ::std::unique_lock<::std::shared_mutex> lock(rules_mutex_);
-  return parseRuleToContainer(rule, rules_, signatures_);
+  const bool parsed = parseRuleToContainer(rule, rules_, signatures_);
+  updateUsesHeaders();
+  return parsed;
 }
 
 void Analyzer::loadRule(internal::Rule rule) noexcept {
   ::std::unique_lock<::std::shared_mutex> lock(rules_mutex_);
   rules_.insert(::std::move(rule));
+  updateUsesHeaders();
 }
 
 void Analyzer::printStats() noexcept {
@@ -206,6 +304,13 @@ void Analyzer::printStats() noexcept {
     current_count = packets_count_.exchange(0);
     internal::coutInfo()
         << "Current speed: " << current_count << " packets per second" << ::std::endl;
+    if (stats_source_) {
+      const auto stats = stats_source_();
+      if (!stats.empty()) {
+        internal::coutInfo() << stats << ::std::endl;
+        logger_.logMessage(stats);
+      }
+    }
     ::std::this_thread::sleep_for(::std::chrono::seconds(stat_interval_));
   }
 }
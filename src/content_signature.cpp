@@ -1,17 +1,18 @@
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <memory>
 #include <unordered_set>
 #include <regex>
 
+#include <netinet/in.h>
 #include <pcap.h>
 
 #include "Packet.h"
-#include "TcpLayer.h"
-#include "UdpLayer.h"
 
 #include "content_signature.h"
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 
 
 namespace flow_inspector::internal {
@@ -41,23 +42,23 @@ ContentSignature::ContentSignature(
   }
 
 bool ContentSignature::check(const Packet& packet) const noexcept {
-  ::std::string packet_data;
+  ::std::string_view packet_data;
 
   switch (protocol_) {
     case Protocols::TCP:
-      if (!extractTcpPayload(packet, packet_data)) {
+      if (!extractPayload(packet, IPPROTO_TCP, packet_data)) {
         return false;
       }
       break;
     case Protocols::UDP:
-      if (!extractUdpPayload(packet, packet_data)) {
+      if (!extractPayload(packet, IPPROTO_UDP, packet_data)) {
         return false;
       }
       break;
     default:
       return false;
   }
-  return packet_data.find(content_) != ::std::string::npos;
+  return packet_data.find(content_) != ::std::string_view::npos;
 }
 
 bool ContentSignature::operator==(const Signature& other) const noexcept {
@@ -78,6 +79,27 @@ size_t ContentSignature::hash() const noexcept {
   return hash_val;
 }
 
+bool ContentSignature::fillBlueprint(PacketBlueprint& blueprint) const noexcept {
+  PacketBlueprint::Transport transport;
+  switch (protocol_) {
+    case Protocols::TCP:
+      transport = PacketBlueprint::Transport::TCP;
+      break;
+    case Protocols::UDP:
+      transport = PacketBlueprint::Transport::UDP;
+      break;
+    default:
+      return false;
+  }
+  if (blueprint.transport.value_or(transport) != transport) {
+    return false;
+  }
+  blueprint.transport = transport;
+  blueprint.payload.insert(blueprint.payload.end(), content_.begin(), content_.end());
+  return true;
+}
+
+
 ::std::unique_ptr<Signature> ContentSignature::createContentSignature(
     const ::std::string& initString) noexcept {
   ::std::istringstream stream(initString);
@@ -100,25 +122,14 @@ size_t ContentSignature::hash() const noexcept {
   return ::std::make_unique<ContentSignature>(protocol, content, flags);
 }
 
-bool ContentSignature::extractTcpPayload(const Packet& packet, ::std::string& payload) const noexcept {
-  const auto& pcpp_packet = packet.getParsedPacket();
-  const auto tcp_layer = pcpp_packet.getLayerOfType<::pcpp::TcpLayer>();
-  if (!tcp_layer) {
-    return false;
-  }
-  payload = ::std::string(
-      reinterpret_cast<const char*>(tcp_layer->getLayerPayload()), tcp_layer->getLayerPayloadSize());
-  return true;
-}
-
-bool ContentSignature::extractUdpPayload(const Packet& packet, ::std::string& payload) const noexcept {
-  const auto& pcpp_packet = packet.getParsedPacket();
-  const auto udp_layer = pcpp_packet.getLayerOfType<::pcpp::UdpLayer>();
-  if (!udp_layer) {
+bool ContentSignature::extractPayload(const Packet& packet, uint8_t protocol,
+    ::std::string_view& payload) const noexcept {
+  const auto& view = packet.getView();
+  if (view.protocol != protocol || !view.l4_offset) {
     return false;
   }
-  payload = ::std::string(
-      reinterpret_cast<const char*>(udp_layer->getLayerPayload()), udp_layer->getLayerPayloadSize());
+  // Нагрузка не копируется: представление ссылается на данные кадра
+  payload = ::std::string_view(reinterpret_cast<const char*>(view.payload.data()), view.payload.size());
   return true;
 }
 
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include <netinet/in.h>
+
+#include "RawPacket.h"
+
+#include "decapsulation.h"
+#include "internal_structs.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr uint16_t kEtherTypeIPv4{0x0800};
+constexpr uint16_t kEtherTypeIPv6{0x86dd};
+constexpr uint16_t kEtherTypeVlan{0x8100};
+constexpr uint16_t kEtherTypeQinQ{0x88a8};
+constexpr uint16_t kEtherTypeMplsUnicast{0x8847};
+constexpr uint16_t kEtherTypeMplsMulticast{0x8848};
+constexpr uint16_t kEtherTypeTransparentBridging{0x6558};
+
+
+uint16_t etherTypeByVersion(byte first_byte) noexcept {
+  switch (first_byte >> 4) {
+    case 4:
+      return kEtherTypeIPv4;
+    case 6:
+      return kEtherTypeIPv6;
+    default:
+      return 0;
+  }
+}
+
+
+class Walker {
+ public:
+  Walker(const byte* data, size_t length, PacketView& view) noexcept
+    : data_{data}
+    , length_{length}
+    , view_{view}
+  {}
+
+  bool walk(size_t offset, uint16_t ether_type, bool ethernet) noexcept {
+    while (true) {
+      if (ethernet && !skipEthernet(offset, ether_type)) {
+        return found_ip_;
+      }
+      if (ether_type == kEtherTypeMplsUnicast || ether_type == kEtherTypeMplsMulticast) {
+        if (!skipMpls(offset, ether_type)) {
+          return found_ip_;
+        }
+      }
+
+      size_t l4_offset = 0;
+      uint8_t protocol = 0;
+      if (!readIp(offset, ether_type, l4_offset, protocol)) {
+        return found_ip_;
+      }
+      if (!l4_offset || view_.depth >= kMaxTunnelDepth
+          || !enterTunnel(l4_offset, protocol, offset, ether_type, ethernet)) {
+        readL4(l4_offset, protocol);
+        return true;
+      }
+    }
+  }
+
+ private:
+  bool skipEthernet(size_t& offset, uint16_t& ether_type) noexcept {
+    if (offset + 14 > length_) {
+      return false;
+    }
+    ether_type = readBigEndian16(data_ + offset + 12);
+    offset += 14;
+    while ((ether_type == kEtherTypeVlan || ether_type == kEtherTypeQinQ) && offset + 4 <= length_) {
+      if (!view_.vlan_id && !view_.depth) {
+        view_.vlan_id = readBigEndian16(data_ + offset) & 0x0fff;
+      }
+      ether_type = readBigEndian16(data_ + offset + 2);
+      offset += 4;
+    }
+    return true;
+  }
+
+  bool skipMpls(size_t& offset, uint16_t& ether_type) noexcept {
+    // Метки идут до бита дна стека; протокол под стеком определяется по версии IP
+    while (offset + 4 <= length_) {
+      const bool bottom = data_[offset + 2] & 0x01;
+      offset += 4;
+      if (bottom) {
+        if (offset >= length_) {
+          return false;
+        }
+        ether_type = etherTypeByVersion(data_[offset]);
+        return ether_type != 0;
+      }
+    }
+    return false;
+  }
+
+  bool readIp(size_t offset, uint16_t ether_type, size_t& l4_offset, uint8_t& protocol) noexcept {
+    size_t ip_end = 0;
+    if (ether_type == kEtherTypeIPv4 && offset + 20 <= length_ && (data_[offset] >> 4) == 4) {
+      const size_t header_length = static_cast<size_t>(data_[offset] & 0x0f) * 4;
+      protocol = data_[offset + 9];
+      // Нулевая длина встречается у кадров, захваченных до сегментации в сетевой карте
+      const size_t total_length = readBigEndian16(data_ + offset + 2);
+      ip_end = total_length >= header_length ? offset + total_length : length_;
+      // У фрагментов, кроме первого, заголовка L4 нет
+      const bool first_fragment = (readBigEndian16(data_ + offset + 6) & 0x1fff) == 0;
+      l4_offset = first_fragment && header_length >= 20 ? offset + header_length : 0;
+    } else if (ether_type == kEtherTypeIPv6 && offset + 40 <= length_ && (data_[offset] >> 4) == 6) {
+      protocol = data_[offset + 6];
+      const size_t payload_length = readBigEndian16(data_ + offset + 4);
+      ip_end = payload_length ? offset + 40 + payload_length : length_;
+      l4_offset = skipIpv6Extensions(offset + 40, protocol);
+    } else {
+      return false;
+    }
+
+    if (!found_ip_) {
+      view_.outer_ip_offset = static_cast<uint32_t>(offset);
+      found_ip_ = true;
+    }
+    const bool ipv4 = ether_type == kEtherTypeIPv4;
+    view_.ip_version = ipv4 ? 4 : 6;
+    view_.ip_offset = static_cast<uint32_t>(offset);
+    view_.protocol = protocol;
+    view_.src_ip = ipv4 ? readBigEndian32(data_ + offset + 12) : 0;
+    view_.dst_ip = ipv4 ? readBigEndian32(data_ + offset + 16) : 0;
+    view_.l4_offset = 0;
+    view_.src_port = 0;
+    view_.dst_port = 0;
+    view_.tcp_flags = 0;
+    view_.payload = {};
+    ip_end_ = ::std::min(ip_end, length_);
+    if (l4_offset >= ip_end_) {
+      l4_offset = 0;
+    }
+    return true;
+  }
+
+  size_t skipIpv6Extensions(size_t offset, uint8_t& protocol) noexcept {
+    for (uint8_t i = 0; i < kMaxTunnelDepth * 2; ++i) {
+      switch (protocol) {
+        case IPPROTO_HOPOPTS:
+        case IPPROTO_ROUTING:
+        case IPPROTO_DSTOPTS:
+          if (offset + 2 > length_) {
+            return 0;
+          }
+          protocol = data_[offset];
+          offset += (static_cast<size_t>(data_[offset + 1]) + 1) * 8;
+          break;
+        case IPPROTO_FRAGMENT:
+          if (offset + 8 > length_ || (readBigEndian16(data_ + offset + 2) & 0xfff8) != 0) {
+            return 0;
+          }
+          protocol = data_[offset];
+          offset += 8;
+          break;
+        default:
+          return offset;
+      }
+    }
+    return 0;
+  }
+
+  bool enterTunnel(size_t l4_offset, uint8_t protocol,
+      size_t& offset, uint16_t& ether_type, bool& ethernet) noexcept {
+    PacketView::Tunnel tunnel = PacketView::Tunnel::None;
+    uint32_t tunnel_id = 0;
+    if (protocol == IPPROTO_GRE) {
+      if (l4_offset + 4 > ip_end_ || (data_[l4_offset + 1] & 0x07) != 0) {
+        return false;
+      }
+      const byte flags = data_[l4_offset];
+      const size_t checksum_length = (flags & 0x80) ? 4 : 0;
+      const size_t key_length = (flags & 0x20) ? 4 : 0;
+      const size_t sequence_length = (flags & 0x10) ? 4 : 0;
+      const size_t header_length = 4 + checksum_length + key_length + sequence_length;
+      if (l4_offset + header_length > ip_end_) {
+        return false;
+      }
+      if (key_length) {
+        const byte* key = data_ + l4_offset + 4 + checksum_length;
+        tunnel_id = readBigEndian32(key);
+      }
+      ether_type = readBigEndian16(data_ + l4_offset + 2);
+      ethernet = ether_type == kEtherTypeTransparentBridging;
+      if (!ethernet && ether_type != kEtherTypeIPv4 && ether_type != kEtherTypeIPv6) {
+        return false;
+      }
+      offset = l4_offset + header_length;
+      tunnel = PacketView::Tunnel::GRE;
+    } else if (protocol == IPPROTO_UDP) {
+      if (l4_offset + 16 > ip_end_ || readBigEndian16(data_ + l4_offset + 2) != kVxlanPort
+          || !(data_[l4_offset + 8] & 0x08)) {
+        return false;
+      }
+      const byte* vni = data_ + l4_offset + 12;
+      tunnel_id = (static_cast<uint32_t>(vni[0]) << 16) | (static_cast<uint32_t>(vni[1]) << 8) | vni[2];
+      offset = l4_offset + 16;
+      ethernet = true;
+      tunnel = PacketView::Tunnel::VXLAN;
+    } else if (protocol == IPPROTO_IPIP || protocol == IPPROTO_IPV6) {
+      offset = l4_offset;
+      ether_type = protocol == IPPROTO_IPIP ? kEtherTypeIPv4 : kEtherTypeIPv6;
+      ethernet = false;
+      tunnel = PacketView::Tunnel::IPinIP;
+    } else {
+      return false;
+    }
+
+    if (!view_.depth) {
+      view_.tunnel = tunnel;
+      view_.tunnel_id = tunnel_id;
+    }
+    ++view_.depth;
+    return true;
+  }
+
+  void readL4(size_t l4_offset, uint8_t protocol) noexcept {
+    if (!l4_offset) {
+      return;
+    }
+    size_t payload_offset = l4_offset;
+    if (protocol == IPPROTO_TCP) {
+      if (l4_offset + 20 > ip_end_) {
+        return;
+      }
+      payload_offset = l4_offset + static_cast<size_t>(data_[l4_offset + 12] >> 4) * 4;
+      view_.tcp_flags = data_[l4_offset + 13];
+    } else if (protocol == IPPROTO_UDP) {
+      if (l4_offset + 8 > ip_end_) {
+        return;
+      }
+      payload_offset = l4_offset + 8;
+    }
+    if (protocol == IPPROTO_TCP || protocol == IPPROTO_UDP) {
+      view_.src_port = readBigEndian16(data_ + l4_offset);
+      view_.dst_port = readBigEndian16(data_ + l4_offset + 2);
+    }
+    view_.l4_offset = static_cast<uint32_t>(l4_offset);
+    payload_offset = ::std::min(payload_offset, ip_end_);
+    view_.payload = {data_ + payload_offset, ip_end_ - payload_offset};
+  }
+
+  const byte* data_;
+  size_t length_;
+  PacketView& view_;
+  size_t ip_end_{0};
+  bool found_ip_{false};
+};
+
+
+template <::pcpp::LinkLayerType LinkType>
+bool decodeLink(const byte* data, size_t length, PacketView& view) noexcept {
+  view = PacketView{};
+  Walker walker{data, length, view};
+  if constexpr (LinkType == ::pcpp::LinkLayerType::LINKTYPE_ETHERNET) {
+    return walker.walk(0, 0, true);
+  } else if constexpr (LinkType == ::pcpp::LinkLayerType::LINKTYPE_RAW) {
+    return length > 0 && walker.walk(0, etherTypeByVersion(data[0]), false);
+  } else if constexpr (LinkType == ::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL) {
+    return length >= 16 && walker.walk(16, readBigEndian16(data + 14), false);
+  } else if constexpr (LinkType == ::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL2) {
+    return length >= 20 && walker.walk(20, readBigEndian16(data), false);
+  } else if constexpr (LinkType == ::pcpp::LinkLayerType::LINKTYPE_NULL) {
+    // Номер семейства адресов зависит от ОС и порядка байтов записавшей машины, поэтому IP определяется по версии
+    return length > 4 && walker.walk(4, etherTypeByVersion(data[4]), false);
+  } else {
+    return false;
+  }
+}
+
+
+}  // namespace
+
+
+LinkDecoder selectLinkDecoder(::pcpp::LinkLayerType link_type) noexcept {
+  switch (link_type) {
+    case ::pcpp::LinkLayerType::LINKTYPE_ETHERNET:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_ETHERNET>;
+    case ::pcpp::LinkLayerType::LINKTYPE_RAW:
+    case ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1:
+    case ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW2:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_RAW>;
+    case ::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL>;
+    case ::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL2:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL2>;
+    case ::pcpp::LinkLayerType::LINKTYPE_NULL:
+    case ::pcpp::LinkLayerType::LINKTYPE_LOOP:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_NULL>;
+    default:
+      return decodeLink<::pcpp::LinkLayerType::LINKTYPE_INVALID>;
+  }
+}
+
+bool decapsulate(const byte* data, size_t length, ::pcpp::LinkLayerType link_type, PacketView& view) noexcept {
+  return selectLinkDecoder(link_type)(data, length, view);
+}
+
+
+}  // namespace flow_inspector::internal
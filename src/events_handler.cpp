@@ -1,4 +1,5 @@
 #include <functional>
+#include <optional>
 #include <unordered_map>
 
 #include "events_handler.h"
@@ -9,6 +10,23 @@
 namespace flow_inspector {
 
 
+thread_local DeferredEvents* EventsHandler::deferred_events_{nullptr};
+
+void DeferredEvents::commit() noexcept {
+  for (const auto& entry : entries_) {
+    entry.handler->dispatchEvent(internal::Event{
+      .type = entry.rule.getType(),
+      .rule = entry.rule,
+      .packet = *entry.packet,
+    });
+  }
+  entries_.clear();
+}
+
+size_t DeferredEvents::size() const noexcept {
+  return entries_.size();
+}
+
 EventsHandler::EventsHandler(Logger& logger) noexcept
   : logger_{logger}
 {
@@ -16,7 +34,7 @@ EventsHandler::EventsHandler(Logger& logger) noexcept
       [this](const internal::Event& event) {
         logger_.logEvent(internal::LogEntry{
           .timestamp = logger_.getTime(),
-          .packet = event.packet.copy(),
+          .packet = event.packet.retain(alert_payload_prefix_),
           .alert = event.rule.getName(),
         });
       });
@@ -28,6 +46,27 @@ void EventsHandler::addEventCallback(
 }
 
 void EventsHandler::addEvent(const internal::Event& event) noexcept {
+  if (deferred_events_) {
+    // Правило может быть заменено при перезагрузке до фиксации, поэтому сохраняются его имя и тип
+    deferred_events_->entries_.push_back(DeferredEvents::Entry{
+      .handler = this,
+      .rule = internal::Rule{event.rule.getName(), event.type},
+      .packet = event.packet.share(),
+    });
+    return;
+  }
+  dispatchEvent(event);
+}
+
+void EventsHandler::deferEvents(DeferredEvents* events) noexcept {
+  deferred_events_ = events;
+}
+
+void EventsHandler::setAlertPayloadPrefix(::std::optional<size_t> payload_prefix) noexcept {
+  alert_payload_prefix_ = payload_prefix;
+}
+
+void EventsHandler::dispatchEvent(const internal::Event& event) noexcept {
   for (const auto& callback : callbacks_[event.type]) {
     callback(event);
   }
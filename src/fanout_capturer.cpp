@@ -0,0 +1,152 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <unistd.h>
+
+#include "fanout_capturer.h"
+#include "packet_ring.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+// Идентификаторы групп, занятые захватом на других интерфейсах этого процесса
+::std::mutex group_ids_mutex;
+::std::set<uint16_t> group_ids;
+
+
+uint16_t acquireGroupId(uint32_t ifindex) noexcept {
+  ::std::lock_guard<::std::mutex> lock(group_ids_mutex);
+  const auto group_id = FanoutCapturer::chooseGroupId(static_cast<uint32_t>(::getpid()), ifindex, group_ids);
+  group_ids.insert(group_id);
+  return group_id;
+}
+
+
+void releaseGroupId(uint16_t group_id) noexcept {
+  ::std::lock_guard<::std::mutex> lock(group_ids_mutex);
+  group_ids.erase(group_id);
+}
+
+
+}  // namespace
+
+
+void FanoutCapturer::setInterfaceName(const ::std::string& interface_name) noexcept {
+  interface_name_ = interface_name;
+}
+
+void FanoutCapturer::setRingConfig(const internal::PacketRing::Config& config) noexcept {
+  config_ = config;
+}
+
+void FanoutCapturer::setWorkersCount(uint8_t workers_count) noexcept {
+  workers_count_ = workers_count ? workers_count : 1;
+}
+
+uint16_t FanoutCapturer::chooseGroupId(uint32_t pid, uint32_t ifindex, const ::std::set<uint16_t>& used) noexcept {
+  // Ядро требует, чтобы все сокеты группы были привязаны к одному устройству,
+  // поэтому у каждого интерфейса процесса своя группа
+  auto group_id = static_cast<uint16_t>((pid << 4) ^ ifindex);
+  while (used.contains(group_id)) {
+    ++group_id;
+  }
+  return group_id;
+}
+
+void FanoutCapturer::startReading() noexcept {
+  const auto ifindex = ::if_nametoindex(interface_name_.c_str());
+  if (ifindex == 0) {
+    ::std::cerr << "Couldn't find device " << interface_name_ << ::std::endl;
+    markFailed();
+    return;
+  }
+  // Симметричный хеш отправляет оба направления одного потока в один и тот же сокет
+  const auto group_id = acquireGroupId(ifindex);
+  ::std::vector<::std::unique_ptr<internal::PacketRing>> rings;
+  for (uint8_t i = 0; i < workers_count_; ++i) {
+    auto ring = ::std::make_unique<internal::PacketRing>();
+    if (!ring->open(interface_name_, config_) || !ring->joinFanout(group_id, PACKET_FANOUT_HASH)) {
+      ::std::cerr << "Couldn't open device " << interface_name_ << ::std::endl;
+      releaseGroupId(group_id);
+      markFailed();
+      return;
+    }
+    rings.push_back(::std::move(ring));
+  }
+
+  ::std::vector<::std::thread> workers;
+  for (auto& ring : rings) {
+    workers.emplace_back(&FanoutCapturer::readRing, this, ::std::ref(*ring));
+  }
+  ::std::string filter;
+  uint32_t snapshot_length = 0;
+  while (!isDoneReading()) {
+    if (takeCaptureFilter(filter, snapshot_length)) {
+      for (auto& ring : rings) {
+        ring->setFilter(filter, snapshot_length);
+      }
+    }
+    updateStatistics(rings);
+    ::std::this_thread::sleep_for(::std::chrono::milliseconds(kPollTimeoutMs));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto& ring : rings) {
+    ring->close();
+  }
+  releaseGroupId(group_id);
+  updateStatistics(rings);
+}
+
+void FanoutCapturer::updateStatistics(
+    const ::std::vector<::std::unique_ptr<internal::PacketRing>>& rings) noexcept {
+  CaptureStatistics statistics;
+  for (const auto& ring : rings) {
+    const auto ring_statistics = ring->getStatistics();
+    statistics.received += ring_statistics.packets;
+    statistics.kernel_drops += ring_statistics.drops;
+    statistics.stalls += ring_statistics.stalls;
+  }
+  setCaptureStatistics(statistics);
+}
+
+void FanoutCapturer::readRing(internal::PacketRing& ring) noexcept {
+  ::std::vector<internal::Packet> batch;
+  auto handler = [&batch](internal::Packet packet) {
+    batch.push_back(::std::move(packet));
+  };
+  while (!isDoneReading()) {
+    if (!ring.readBlock(kPollTimeoutMs, handler)) {
+      ::std::cerr << "Error reading packet ring of " << interface_name_ << ::std::endl;
+      break;
+    }
+    flushBatch(batch);
+  }
+}
+
+void FanoutCapturer::internalStopReading() noexcept {}
+
+bool FanoutCapturer::hasOwnWorkers() const noexcept {
+  return true;
+}
+
+::pcpp::LinkLayerType FanoutCapturer::getLinkLayerType() noexcept {
+  return internal::PacketRing::queryLinkLayerType(interface_name_);
+}
+
+
+}  // namespace flow_inspector
@@ -1,9 +1,17 @@
+#include <memory>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+
 #include "analyzer.h"
 #include "debug_logger.h"
 #include "events_handler.h"
 #include "ids.h"
 #include "pcap_writer.h"
 #include "logger.h"
+#include "packet_buffer_pool.h"
+#include "packet_deduplicator.h"
 #include "packet_processors_pool.h"
 #include "packet_origin.h"
 
@@ -13,11 +21,32 @@ namespace flow_inspector {
 
 IDS::IDS(const uint8_t numPacketProcessors, ::std::unique_ptr<PacketOrigin> origin) noexcept
   : pcap_writer_{origin->getLinkLayerType()}
-  , pool_{analyzer_, numPacketProcessors}
+  , pool_{analyzer_, origin->hasOwnWorkers() ? uint8_t{0} : numPacketProcessors}
   , origin_{::std::move(origin)}
 {
-  origin_->setProcessor([this](auto packet) {
-    pool_.addPacket(::std::move(packet));
+  analyzer_.setLinkLayerType(origin_->getLinkLayerType());
+  if (origin_->hasOwnWorkers()) {
+    origin_->setProcessor([this](auto packet) {
+      if (!deduplicator_ || !deduplicator_->isDuplicate(packet)) {
+        pool_.analyzePacket(packet);
+      }
+    });
+    origin_->setBatchProcessor([this](auto packets) {
+      pool_.analyzePackets(removeDuplicates(packets));
+    });
+  } else {
+    origin_->setProcessor([this](auto packet) {
+      if (!deduplicator_ || !deduplicator_->isDuplicate(packet)) {
+        pool_.addPacket(::std::move(packet));
+      }
+    });
+    origin_->setBatchProcessor([this](auto packets) {
+      pool_.addPackets(removeDuplicates(packets));
+    });
+  }
+  analyzer_.setStatsSource([this]() {
+    const auto origin_stats = origin_->getStatistics();
+    return (origin_stats.empty() ? "" : origin_stats + "\n") + getCaptureStatistics();
   });
   events_handler_.addEventCallback(internal::Event::EventType::SaveToPcap,
       [this](const internal::Event& event) {
@@ -25,9 +54,10 @@ IDS::IDS(const uint8_t numPacketProcessors, ::std::unique_ptr<PacketOrigin> orig
       });
 }
 
-void IDS::start() noexcept {
+bool IDS::start() noexcept {
   internal::coutInfo() << "Starting reading packets" << std::endl;
   origin_->startReading();
+  return !origin_->hasFailed();
 }
 
 void IDS::stop() noexcept {
@@ -36,6 +66,64 @@ void IDS::stop() noexcept {
 
 void IDS::loadRules(const ::std::string& filename) noexcept {
   VERIFY(loadFile(analyzer_, filename), "Failed to load rules from file");
+  if (prefilter_enabled_) {
+    const auto filter = analyzer_.getCaptureFilter();
+    logger_.logMessage("Capture filter: " + (filter.empty() ? ::std::string{"<none>"} : filter));
+    origin_->setCaptureFilter(filter);
+    const auto snapshot_length = analyzer_.getSnapshotLength();
+    logger_.logMessage("Snapshot length: "
+        + (snapshot_length ? ::std::to_string(snapshot_length) : ::std::string{"<full frames>"}));
+    origin_->setSnapshotLength(snapshot_length);
+  }
+  origin_->setRuleBlueprints(analyzer_.getRuleBlueprints());
+}
+
+void IDS::setPrefilterEnabled(bool enabled) noexcept {
+  prefilter_enabled_ = enabled;
+}
+
+void IDS::setQueueLimit(size_t max_queue_depth) noexcept {
+  pool_.setMaxQueueDepth(max_queue_depth);
+}
+
+void IDS::setDeduplication(const internal::PacketDeduplicator::Config& config) noexcept {
+  deduplicator_ = ::std::make_unique<internal::PacketDeduplicator>(config);
+}
+
+void IDS::setAlertPayloadPrefix(::std::optional<size_t> payload_prefix) noexcept {
+  events_handler_.setAlertPayloadPrefix(payload_prefix);
+}
+
+::std::span<internal::Packet> IDS::removeDuplicates(::std::span<internal::Packet> packets) noexcept {
+  if (!deduplicator_) {
+    return packets;
+  }
+  return packets.first(deduplicator_->removeDuplicates(packets));
+}
+
+::std::string IDS::getCaptureStatistics() noexcept {
+  ::std::ostringstream result;
+  result << "Capture:";
+  PacketOrigin::CaptureStatistics statistics;
+  if (origin_->getCaptureStatistics(statistics)) {
+    result << " received " << statistics.received
+        << ", dropped by kernel " << statistics.kernel_drops
+        << ", dropped by interface " << statistics.interface_drops << ",";
+    if (statistics.stalls) {
+      result << " waits for unreleased capture buffers " << statistics.stalls << ",";
+    }
+  }
+  result << " queue depth " << pool_.getQueueDepth()
+      << ", dropped in userspace " << pool_.getDroppedCount();
+  if (deduplicator_) {
+    result << ", duplicates removed " << deduplicator_->getDuplicatesCount();
+  }
+  const auto pool_statistics = internal::PacketBufferPool::getTotalStatistics();
+  if (pool_statistics.buffers) {
+    result << ", packet buffers in use " << pool_statistics.buffers_in_use << "/" << pool_statistics.buffers
+        << ", pool misses " << pool_statistics.exhausted + pool_statistics.oversized;
+  }
+  return result.str();
 }
 
 void IDS::setLogLevel(Logger::LogLevel level) noexcept {
@@ -55,8 +143,12 @@ void IDS::setPcapOutputFilename(const ::std::string& filename) noexcept {
 }
 
 IDS::~IDS() noexcept {
+  // Источник статистики обращается к origin_, pool_ и deduplicator_, которые уничтожаются раньше analyzer_
+  analyzer_.setStatSpeed(0);
   pool_.finish();
-  logger_.logMessage("IDS stopped.");
+  const auto summary = getCaptureStatistics();
+  internal::coutInfo() << summary << ::std::endl;
+  logger_.logMessage("IDS stopped. " + summary);
 }
 
 
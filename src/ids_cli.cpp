@@ -1,10 +1,26 @@
+#include <sstream>
+#include <string>
+#include <string_view>
+
 #include "cxxopts.hpp"
 
 #include "ids_cli.h"
 #include "ids.h"
 #include "debug_logger.h"
+#include "fanout_capturer.h"
+#include "mmap_pcap_reader.h"
+#include "multi_interface_capturer.h"
+#include "multi_pcap_reader.h"
+#include "nfqueue_capturer.h"
+#include "parallel_pcap_reader.h"
 #include "pcap_reader.h"
+#include "replay_reader.h"
+#include "ring_capturer.h"
+#include "shm_ring_reader.h"
+#include "stream_pcap_reader.h"
 #include "traffic_capturer.h"
+#include "traffic_generator.h"
+#include "xdp_capturer.h"
 
 
 namespace flow_inspector {
@@ -14,12 +30,80 @@ IdsCli::IdsCli(int argc, char **argv) {
   ::cxxopts::Options options("FlowInspector", "CLI wrapper for flow inspector");
 
   options.add_options()
-    ("m,mode", "Operating mode: 'pcap' for file input or 'live' for real-time capture",
+    ("m,mode", "Operating mode: 'pcap' for file input, 'live' for real-time capture, "
+        "'ring' for real-time capture through a zero-copy TPACKET_V3 ring, 'fanout' for "
+        "ring capture split by flow between -j capture threads, 'xdp' for AF_XDP capture, "
+        "'replay' for paced replay of a PCAP file, 'generate' for synthetic traffic generated "
+        "in process by -j threads, 'nfqueue' for inline filtering of netfilter NFQUEUE traffic, "
+        "where packets matching Alert rules are dropped, or 'shm' for packets written by an external "
+        "capture process into a shared memory ring",
         ::cxxopts::value<::std::string>())
-    ("i,interface", "Network interface for live mode capture (only used with live mode)",
+    ("i,interface", "Network interface for live mode capture (only used with live, ring, fanout and xdp modes). "
+        "A comma-separated list captures from all of them at once, one capture thread per interface",
         ::cxxopts::value<::std::string>())
-    ("f,file", "Path to the PCAP file for input (applicable only in pcap mode)",
+    ("pcap-buffer-size", "Size of the libpcap kernel buffer in bytes, 0 for the libpcap default (live mode)",
+        ::cxxopts::value<int>()->default_value("0"))
+    ("pcap-timeout", "libpcap buffer timeout in milliseconds, 0 for the PcapPlusPlus default (live mode)",
+        ::cxxopts::value<int>()->default_value("0"))
+    ("pcap-direction", "Captured traffic direction: 'in', 'out' or 'inout' (live mode)",
+        ::cxxopts::value<::std::string>()->default_value("inout"))
+    ("snaplen", "Number of bytes captured from each frame, 0 to derive it from the loaded rules (live mode)",
+        ::cxxopts::value<uint32_t>()->default_value("0"))
+    ("no-promiscuous", "Don't put the interface into promiscuous mode (live mode)")
+    ("pcap-auto-tune", "Double the libpcap kernel buffer whenever the kernel drops packets (live mode)")
+    ("pcap-max-buffer-size", "Upper bound for the libpcap kernel buffer grown by --pcap-auto-tune (live mode)",
+        ::cxxopts::value<int>()->default_value("268435456"))
+    ("ring-block-size", "Size of a single TPACKET_V3 ring block in bytes (ring and fanout modes)",
+        ::cxxopts::value<uint32_t>()->default_value("4194304"))
+    ("ring-blocks", "Number of blocks in each TPACKET_V3 ring (ring and fanout modes)",
+        ::cxxopts::value<uint32_t>()->default_value("64"))
+    ("xdp-attach", "AF_XDP attach mode: 'skb', 'driver' or 'auto' (xdp mode)",
+        ::cxxopts::value<::std::string>()->default_value("auto"))
+    ("xdp-frames", "Number of UMEM frames of the AF_XDP socket (xdp mode)",
+        ::cxxopts::value<uint16_t>()->default_value("4096"))
+    ("xdp-ring-size", "Size of the AF_XDP fill, completion, RX and TX rings, a power of two (xdp mode)",
+        ::cxxopts::value<uint32_t>()->default_value("2048"))
+    ("nfqueue", "Comma-separated NFQUEUE numbers or ranges, one worker thread per queue (nfqueue mode)",
+        ::cxxopts::value<::std::string>()->default_value("0"))
+    ("nfqueue-maxlen", "Maximal number of packets waiting for a verdict in each kernel queue (nfqueue mode)",
+        ::cxxopts::value<uint32_t>()->default_value("4096"))
+    ("nfqueue-fail-closed", "Drop packets instead of accepting them when a kernel queue is full, and keep "
+        "analyzing every packet when the queue is 75% full instead of accepting it unanalyzed (nfqueue mode)")
+    ("shm-ring", "Name of the shared memory ring in /dev/shm created by the capture process (shm mode)",
+        ::cxxopts::value<::std::string>()->default_value("flow_inspector"))
+    ("f,file", "Path to the PCAP file for input (applicable only in pcap mode). A directory, a glob "
+        "or a comma-separated list merges all matching files by packet timestamp. '-' or a FIFO "
+        "is read as a stream, e.g. from tcpdump -w - or a decompressor",
         ::cxxopts::value<::std::string>())
+    ("replay-speed", "Replay speed as a multiple of the capture timestamps, 0 for unlimited (replay mode)",
+        ::cxxopts::value<double>()->default_value("1"))
+    ("replay-pps", "Replay at a fixed rate in packets per second, overrides --replay-speed (replay mode)",
+        ::cxxopts::value<uint64_t>()->default_value("0"))
+    ("replay-mbps", "Replay at a fixed rate in megabits per second, overrides --replay-speed (replay mode)",
+        ::cxxopts::value<double>()->default_value("0"))
+    ("replay-loops", "Number of passes over the file, 0 to loop until stopped (replay mode)",
+        ::cxxopts::value<size_t>()->default_value("1"))
+    ("gen-packets", "Number of packets to generate, 0 to generate until stopped (generate mode)",
+        ::cxxopts::value<uint64_t>()->default_value("0"))
+    ("gen-flows", "Number of distinct flows in the generated traffic (generate mode)",
+        ::cxxopts::value<size_t>()->default_value("1024"))
+    ("gen-min-size", "Minimal generated frame size in bytes (generate mode)",
+        ::cxxopts::value<size_t>()->default_value("64"))
+    ("gen-max-size", "Maximal generated frame size in bytes, sizes are uniform in between (generate mode)",
+        ::cxxopts::value<size_t>()->default_value("1500"))
+    ("gen-alphabet", "Symbols of the generated payloads, empty for arbitrary bytes (generate mode)",
+        ::cxxopts::value<::std::string>()->default_value("abcdefghijklmnopqrstuvwxyz0123456789"))
+    ("gen-hit-percent", "Percentage of generated packets built to match a loaded rule (generate mode)",
+        ::cxxopts::value<double>()->default_value("0"))
+    ("gen-mix", "Weights of TCP, UDP and ICMP packets as 'tcp,udp,icmp' (generate mode)",
+        ::cxxopts::value<::std::string>()->default_value("80,15,5"))
+    ("gen-seed", "Seed of the generator, equal seeds produce equal traffic (generate mode)",
+        ::cxxopts::value<uint64_t>()->default_value("1"))
+    ("readers", "Number of threads reading files when several PCAP files are merged (pcap mode)",
+        ::cxxopts::value<uint8_t>()->default_value("2"))
+    ("mmap", "Read the PCAP file through a memory mapping without copying packets (pcap mode)")
+    ("chunked", "Split the PCAP file into chunks analyzed concurrently by -j threads, "
+        "keeping alerts in packet order (pcap mode)")
     ("j,cores", "Number of processor cores to utilize",
         ::cxxopts::value<uint8_t>()->default_value("1"))
     ("o,log-output", "Path to the file for logging output",
@@ -30,6 +114,30 @@ IdsCli::IdsCli(int argc, char **argv) {
         ::cxxopts::value<::std::string>()->default_value(""))
     ("s,stat-speed", "Interval (in seconds) for printing capture statistics",
         ::cxxopts::value<::size_t>()->default_value("0"))
+    ("queue-limit", "Maximal number of packets waiting for the -j processing threads, newer packets are "
+        "dropped and counted in the statistics, 0 for no limit. The default applies to live capture modes "
+        "(live, ring, fanout, xdp, nfqueue), other modes queue every packet unless the limit is given",
+        ::cxxopts::value<size_t>()->default_value("1048576"))
+    ("dedup-window", "Drop repeated copies of a packet seen within this many milliseconds, as delivered by "
+        "SPAN ports, 0 to keep every packet",
+        ::cxxopts::value<uint32_t>()->default_value("0"))
+    ("dedup-table-size", "Number of packet hashes remembered for --dedup-window",
+        ::cxxopts::value<size_t>()->default_value("65536"))
+    ("alert-packet", "Part of an alerted packet kept in the log: 'full', 'headers', or 'headers+N' for the "
+        "headers and the first N payload bytes. Smaller parts release capture buffers sooner",
+        ::cxxopts::value<::std::string>()->default_value("full"))
+    ("packet-pool-size", "Number of preallocated packet buffers per packet-creating thread, 0 to allocate "
+        "every packet on the heap",
+        ::cxxopts::value<size_t>()->default_value("4096"))
+    ("packet-buffer-size", "Size of a preallocated packet buffer in bytes, longer frames are allocated on the heap",
+        ::cxxopts::value<size_t>()->default_value("2048"))
+    ("huge-pages", "Back the packet buffers with explicit huge pages: off, 2M or 1G. Pools smaller than "
+        "half a 1G page use 2M pages. Falls back to transparent huge pages when none are reserved",
+        ::cxxopts::value<::std::string>()->default_value("off"))
+    ("lock-memory", "Lock the packet buffers and the shared memory ring in RAM so analysis never page-faults, "
+        "limited by RLIMIT_MEMLOCK")
+    ("no-prefilter", "Don't install a kernel capture filter and snapshot length derived from the loaded rules "
+        "(live, ring and fanout modes)")
     ("log-level", "Logging to stdout verbosity level: debug or info",
         ::cxxopts::value<::std::string>()->default_value("info"))
     ("h,help", "Display this help message");
@@ -48,20 +156,98 @@ IdsCli::IdsCli(int argc, char **argv) {
     }
 
     mode_ = result["mode"].as<::std::string>();
-    if (mode_ == "live") {
+    if (mode_ == "live" || mode_ == "ring" || mode_ == "fanout" || mode_ == "xdp") {
       if (result.count("interface")) {
-        interface_ = result["interface"].as<::std::string>();
-      } else {
+        ::std::istringstream interfaces(result["interface"].as<::std::string>());
+        ::std::string interface_name;
+        while (::std::getline(interfaces, interface_name, ',')) {
+          if (!interface_name.empty()) {
+            interfaces_.push_back(interface_name);
+          }
+        }
+      }
+      if (interfaces_.empty()) {
         throw ::std::invalid_argument("Interface is required for live mode");
       }
+    } else if (mode_ == "replay") {
+      if (result.count("file")) {
+        pcap_file_ = result["file"].as<::std::string>();
+      } else {
+        throw ::std::invalid_argument("File is required for replay mode");
+      }
+      replay_config_.speed = result["replay-speed"].as<double>();
+      replay_config_.target_pps = result["replay-pps"].as<uint64_t>();
+      replay_config_.target_mbps = result["replay-mbps"].as<double>();
+      replay_config_.loops = result["replay-loops"].as<size_t>();
     } else if (mode_ == "pcap") {
       if (result.count("file")) {
         pcap_file_ = result["file"].as<::std::string>();
+        mmap_pcap_ = result.count("mmap") > 0;
+        chunked_pcap_ = result.count("chunked") > 0;
+        stream_pcap_ = StreamPcapReader::isStream(pcap_file_);
+        pcap_files_ = stream_pcap_ ? ::std::vector{pcap_file_} : MultiPcapReader::resolveInputs(pcap_file_);
+        if (pcap_files_.empty()) {
+          throw ::std::invalid_argument("No PCAP files match " + pcap_file_);
+        }
+        const bool single_file = !stream_pcap_ && pcap_files_.size() == 1 && pcap_files_.front() == pcap_file_;
+        if ((mmap_pcap_ || chunked_pcap_) && !single_file) {
+          throw ::std::invalid_argument("--mmap and --chunked read a single regular pcap file, "
+              "not a stream or several inputs");
+        }
+        readers_ = result["readers"].as<uint8_t>();
       } else {
         throw ::std::invalid_argument("File is required for pcap mode");
       }
+    } else if (mode_ == "generate") {
+      generator_config_.packets = result["gen-packets"].as<uint64_t>();
+      generator_config_.flows = result["gen-flows"].as<size_t>();
+      generator_config_.min_size = result["gen-min-size"].as<size_t>();
+      generator_config_.max_size = result["gen-max-size"].as<size_t>();
+      generator_config_.alphabet = result["gen-alphabet"].as<::std::string>();
+      generator_config_.hit_percent = result["gen-hit-percent"].as<double>();
+      generator_config_.seed = result["gen-seed"].as<uint64_t>();
+      char separator1 = 0, separator2 = 0;
+      ::std::istringstream mix(result["gen-mix"].as<::std::string>());
+      if (!(mix >> generator_config_.tcp_weight >> separator1 >> generator_config_.udp_weight
+          >> separator2 >> generator_config_.icmp_weight) || separator1 != ',' || separator2 != ','
+          || generator_config_.tcp_weight + generator_config_.udp_weight + generator_config_.icmp_weight == 0) {
+        throw ::std::invalid_argument("Invalid protocol mix, use 'tcp,udp,icmp' weights");
+      }
+    } else if (mode_ == "nfqueue") {
+      nfqueue_config_.queues.clear();
+      ::std::istringstream queues(result["nfqueue"].as<::std::string>());
+      ::std::string range;
+      while (::std::getline(queues, range, ',')) {
+        unsigned first = 0, last = 0;
+        char separator = 0;
+        ::std::istringstream bounds(range);
+        if (!(bounds >> first)) {
+          throw ::std::invalid_argument("Invalid NFQUEUE numbers, use a list like '0,2-5'");
+        }
+        last = first;
+        if (bounds >> separator && (separator != '-' || !(bounds >> last))) {
+          throw ::std::invalid_argument("Invalid NFQUEUE numbers, use a list like '0,2-5'");
+        }
+        if (last < first || last > 0xffff) {
+          throw ::std::invalid_argument("Invalid NFQUEUE range " + range);
+        }
+        for (unsigned queue = first; queue <= last; ++queue) {
+          nfqueue_config_.queues.push_back(static_cast<uint16_t>(queue));
+        }
+      }
+      if (nfqueue_config_.queues.empty()) {
+        throw ::std::invalid_argument("At least one NFQUEUE number is required for nfqueue mode");
+      }
+      nfqueue_config_.queue.max_length = result["nfqueue-maxlen"].as<uint32_t>();
+      nfqueue_config_.queue.fail_open = result.count("nfqueue-fail-closed") == 0;
+      if (result["dedup-window"].as<uint32_t>()) {
+        throw ::std::invalid_argument("Deduplication can't be used in nfqueue mode, every packet needs a verdict");
+      }
+    } else if (mode_ == "shm") {
+      shm_ring_name_ = result["shm-ring"].as<::std::string>();
     } else {
-      throw ::std::invalid_argument("Invalid mode, use 'live' or 'pcap'");
+      throw ::std::invalid_argument(
+          "Invalid mode, use 'live', 'ring', 'fanout', 'xdp', 'pcap', 'replay', 'generate', 'nfqueue' or 'shm'");
     }
 
     const auto& log_level = result["log-level"].as<::std::string>();
@@ -75,6 +261,74 @@ IdsCli::IdsCli(int argc, char **argv) {
     output_log_file_ = result["log-output"].as<::std::string>();
     pcap_output_file_ = result["write"].as<::std::string>();
     stat_speed_ = result["stat-speed"].as<size_t>();
+    prefilter_ = result.count("no-prefilter") == 0;
+    // Файлы, повтор, генератор и shm-кольцо могут ждать обработчиков, поэтому по умолчанию пакеты не теряются
+    const bool live_capture = mode_ == "live" || mode_ == "ring" || mode_ == "fanout" || mode_ == "xdp"
+        || mode_ == "nfqueue";
+    queue_limit_ = live_capture || result.count("queue-limit") ? result["queue-limit"].as<size_t>() : 0;
+    dedup_config_.window_ms = result["dedup-window"].as<uint32_t>();
+    dedup_config_.table_size = result["dedup-table-size"].as<size_t>();
+    const auto& alert_packet = result["alert-packet"].as<::std::string>();
+    if (alert_packet == "headers") {
+      alert_payload_prefix_ = 0;
+    } else if (alert_packet.starts_with("headers+")) {
+      size_t payload_prefix = 0;
+      ::std::istringstream prefix(alert_packet.substr(::std::string_view{"headers+"}.size()));
+      if (!(prefix >> payload_prefix) || !prefix.eof()) {
+        throw ::std::invalid_argument("Invalid alert packet part " + alert_packet);
+      }
+      alert_payload_prefix_ = payload_prefix;
+    } else if (alert_packet != "full") {
+      throw ::std::invalid_argument("Invalid alert packet part " + alert_packet);
+    }
+    packet_pool_config_.buffer_count = result["packet-pool-size"].as<size_t>();
+    packet_pool_config_.buffer_size = result["packet-buffer-size"].as<size_t>();
+    const auto& huge_pages = result["huge-pages"].as<::std::string>();
+    if (huge_pages == "2M") {
+      packet_pool_config_.memory.huge_page_size = internal::PacketMemory::kHugePageSize2M;
+    } else if (huge_pages == "1G") {
+      packet_pool_config_.memory.huge_page_size = internal::PacketMemory::kHugePageSize1G;
+    } else if (huge_pages != "off") {
+      throw ::std::invalid_argument("Invalid huge page size, use 'off', '2M' or '1G'");
+    }
+    packet_pool_config_.memory.lock = result.count("lock-memory") > 0;
+    capture_config_.buffer_size = result["pcap-buffer-size"].as<int>();
+    capture_config_.buffer_timeout_ms = result["pcap-timeout"].as<int>();
+    capture_config_.snapshot_length = result["snaplen"].as<uint32_t>();
+    capture_config_.promiscuous = result.count("no-promiscuous") == 0;
+    capture_config_.auto_tune = result.count("pcap-auto-tune") > 0;
+    capture_config_.max_buffer_size = result["pcap-max-buffer-size"].as<int>();
+    const auto& pcap_direction = result["pcap-direction"].as<::std::string>();
+    if (pcap_direction == "in") {
+      capture_config_.direction = ::pcpp::PcapLiveDevice::PCPP_IN;
+    } else if (pcap_direction == "out") {
+      capture_config_.direction = ::pcpp::PcapLiveDevice::PCPP_OUT;
+    } else if (pcap_direction == "inout") {
+      capture_config_.direction = ::pcpp::PcapLiveDevice::PCPP_INOUT;
+    } else {
+      throw ::std::invalid_argument("Invalid capture direction, use 'in', 'out' or 'inout'");
+    }
+    ring_config_.block_size = result["ring-block-size"].as<uint32_t>();
+    ring_config_.block_count = result["ring-blocks"].as<uint32_t>();
+
+    const auto& xdp_attach = result["xdp-attach"].as<::std::string>();
+    if (xdp_attach == "skb") {
+      xdp_config_.attach_mode = XdpCapturer::AttachMode::Skb;
+    } else if (xdp_attach == "driver") {
+      xdp_config_.attach_mode = XdpCapturer::AttachMode::Driver;
+    } else if (xdp_attach == "auto") {
+      xdp_config_.attach_mode = XdpCapturer::AttachMode::Auto;
+    } else {
+      throw ::std::invalid_argument("Invalid XDP attach mode, use 'skb', 'driver' or 'auto'");
+    }
+    xdp_config_.umem_frames = result["xdp-frames"].as<uint16_t>();
+    xdp_config_.ring_size = result["xdp-ring-size"].as<uint32_t>();
+#ifndef FLOW_INSPECTOR_USE_XDP
+    if (mode_ == "xdp") {
+      throw ::std::invalid_argument("FlowInspector is built without XDP support, "
+          "reconfigure it with -DFLOW_INSPECTOR_USE_XDP=ON");
+    }
+#endif
 
   } catch (const ::cxxopts::exceptions::exception& e) {
     ::std::cout << options.help() << ::std::endl;
@@ -93,16 +347,93 @@ void IdsCli::updateRules() noexcept {
   }
 }
 
-void IdsCli::start() noexcept {
+::std::unique_ptr<PacketOrigin> IdsCli::makeCapturer(const ::std::string& interface_name) noexcept {
+  if (mode_ == "ring") {
+    auto capturer = ::std::make_unique<RingCapturer>();
+    capturer->setInterfaceName(interface_name);
+    capturer->setRingConfig(ring_config_);
+    return capturer;
+  } else if (mode_ == "fanout") {
+    auto capturer = ::std::make_unique<FanoutCapturer>();
+    capturer->setInterfaceName(interface_name);
+    capturer->setRingConfig(ring_config_);
+    capturer->setWorkersCount(cores_);
+    return capturer;
+#ifdef FLOW_INSPECTOR_USE_XDP
+  } else if (mode_ == "xdp") {
+    auto capturer = ::std::make_unique<XdpCapturer>();
+    capturer->setInterfaceName(interface_name);
+    capturer->setXdpConfig(xdp_config_);
+    return capturer;
+#endif
+  }
+  auto capturer = ::std::make_unique<TrafficCapturer>();
+  capturer->setInterfaceName(interface_name);
+  capturer->setCaptureConfig(capture_config_);
+  return capturer;
+}
+
+bool IdsCli::start() noexcept {
   ::std::unique_ptr<PacketOrigin> packet_origin;
-  if (mode_ == "live") {
-    packet_origin = ::std::make_unique<TrafficCapturer>();
-    static_cast<TrafficCapturer*>(packet_origin.get())->setInterfaceName(interface_);
+  if (mode_ == "live" || mode_ == "ring" || mode_ == "fanout" || mode_ == "xdp") {
+    if (interfaces_.size() == 1) {
+      packet_origin = makeCapturer(interfaces_.front());
+    } else {
+      auto capturer = ::std::make_unique<MultiInterfaceCapturer>();
+      for (const auto& interface_name : interfaces_) {
+        capturer->addInterface(interface_name, makeCapturer(interface_name));
+      }
+      packet_origin = ::std::move(capturer);
+    }
+  } else if (mode_ == "replay") {
+    auto reader = ::std::make_unique<ReplayReader>();
+    reader->setFilename(pcap_file_);
+    reader->setReplayConfig(replay_config_);
+    packet_origin = ::std::move(reader);
+  } else if (mode_ == "nfqueue") {
+    auto capturer = ::std::make_unique<NfqueueCapturer>();
+    capturer->setNfqueueConfig(nfqueue_config_);
+    packet_origin = ::std::move(capturer);
+  } else if (mode_ == "shm") {
+    auto reader = ::std::make_unique<ShmRingReader>();
+    reader->setRingName(shm_ring_name_);
+    reader->setLockMemory(packet_pool_config_.memory.lock);
+    packet_origin = ::std::move(reader);
+  } else if (mode_ == "generate") {
+    auto generator = ::std::make_unique<TrafficGenerator>();
+    generator->setGeneratorConfig(generator_config_);
+    generator->setWorkersCount(cores_);
+    packet_origin = ::std::move(generator);
+  } else if (mode_ == "pcap" && stream_pcap_) {
+    auto reader = ::std::make_unique<StreamPcapReader>();
+    reader->setFilename(pcap_file_);
+    packet_origin = ::std::move(reader);
+  } else if (mode_ == "pcap" && (pcap_files_.size() > 1 || pcap_files_.front() != pcap_file_)) {
+    auto reader = ::std::make_unique<MultiPcapReader>();
+    reader->setFilenames(pcap_files_);
+    reader->setReadersCount(readers_);
+    packet_origin = ::std::move(reader);
+  } else if (mode_ == "pcap" && chunked_pcap_) {
+    auto reader = ::std::make_unique<ParallelPcapReader>();
+    reader->setFilename(pcap_file_);
+    reader->setWorkersCount(cores_);
+    packet_origin = ::std::move(reader);
+  } else if (mode_ == "pcap" && mmap_pcap_) {
+    auto reader = ::std::make_unique<MmapPcapReader>();
+    reader->setFilename(pcap_file_);
+    packet_origin = ::std::move(reader);
   } else if (mode_ == "pcap") {
     packet_origin = ::std::make_unique<PcapReader>();
     static_cast<PcapReader*>(packet_origin.get())->setFilename(pcap_file_);
   }
+  internal::PacketBufferPool::setThreadPoolConfig(packet_pool_config_);
   ids_.emplace(cores_, ::std::move(packet_origin));
+  ids_->setPrefilterEnabled(prefilter_);
+  ids_->setQueueLimit(queue_limit_);
+  if (dedup_config_.window_ms) {
+    ids_->setDeduplication(dedup_config_);
+  }
+  ids_->setAlertPayloadPrefix(alert_payload_prefix_);
   if (!rules_file_.empty()) {
     ids_->loadRules(rules_file_);
   }
@@ -115,7 +446,7 @@ void IdsCli::start() noexcept {
               << (rules_file_.empty() ? "<no rules file specified>" : rules_file_) << ::std::endl;
   ::std::cout << "Process ID: " << ::getpid() << ::std::endl;
   
-  ids_->start();
+  return ids_->start();
 }
 
 void IdsCli::stop() noexcept {
@@ -8,6 +8,7 @@
 #include <memory>
 #include <span>
 #include <cstdlib>
+#include <utility>
 
 #include <pcap.h>
 
@@ -15,7 +16,9 @@
 #include "RawPacket.h"
 
 #include "debug_logger.h"
+#include "decapsulation.h"
 #include "internal_structs.h"
+#include "packet_buffer_pool.h"
 
 
 ::std::string trim(const ::std::string& str) noexcept {
@@ -100,27 +103,87 @@ ByteVector byteVectorFromPCPP(const ::pcpp::RawPacket& packet) noexcept {
 
 Packet::Packet() noexcept {}
 
-Packet::Packet(const ::pcpp::RawPacket& _packet, bool parse_at_init) noexcept
-    : packet{::std::make_unique<::pcpp::RawPacket>(_packet)}
-{
+Packet::Packet(const ::pcpp::RawPacket& _packet, bool parse_at_init) noexcept {
+  const auto& pool = PacketBufferPool::getThreadPool();
+  const auto length = static_cast<size_t>(_packet.getRawDataLen());
+  PacketBufferPool::Slot slot;
+  if (pool && pool->acquireSlot(length, slot)) {
+    ::std::memcpy(slot.buffer, _packet.getRawData(), length);
+    slot.raw_packet->setRawData(slot.buffer, static_cast<int>(length), _packet.getPacketTimeStamp(),
+        _packet.getLinkLayerType(), _packet.getFrameLength());
+    packet.reset(slot.raw_packet);
+    buffer_ = slot.buffer;
+    pool_ = pool;
+  } else {
+    packet = ::std::make_unique<::pcpp::RawPacket>(_packet);
+  }
   if (parse_at_init) {
     parse();
   }
 }
 
+Packet::Packet(const byte* data, size_t length, const timespec& timestamp,
+    ::pcpp::LinkLayerType link_type, ::std::shared_ptr<const void> holder) noexcept
+  : holder_{::std::move(holder)}
+  , external_{static_cast<bool>(holder_)}
+{
+  const auto& pool = PacketBufferPool::getThreadPool();
+  if (pool) {
+    packet = pool->acquireRawPacket();
+    packet->initWithRawData(data, static_cast<int>(length), timestamp, link_type);
+    pool_ = pool;
+  } else {
+    packet = ::std::make_unique<::pcpp::RawPacket>(data, static_cast<int>(length), timestamp, false, link_type);
+  }
+}
+
 Packet::Packet(Packet&& other) noexcept
   : packet{::std::move(other.packet)}
+  , alerted{other.alerted}
   , parsed_packet{::std::move(other.parsed_packet)}
+  , view_{other.view_}
+  , view_ready_{other.view_ready_}
+  , holder_{::std::move(other.holder_)}
+  , external_{other.external_}
+  , pool_{::std::move(other.pool_)}
+  , buffer_{::std::exchange(other.buffer_, nullptr)}
+  , shared_{::std::move(other.shared_)}
 {}
 
+Packet::~Packet() noexcept {
+  release();
+}
+
 Packet& Packet::operator=(Packet&& other) noexcept {
   if (this != &other) {
-    packet = ::std::move(other.packet);
+    release();
     parsed_packet = ::std::move(other.parsed_packet);
+    packet = ::std::move(other.packet);
+    alerted = other.alerted;
+    view_ = other.view_;
+    view_ready_ = other.view_ready_;
+    holder_ = ::std::move(other.holder_);
+    external_ = other.external_;
+    pool_ = ::std::move(other.pool_);
+    buffer_ = ::std::exchange(other.buffer_, nullptr);
+    shared_ = ::std::move(other.shared_);
   }
   return *this;
 }
 
+void Packet::release() noexcept {
+  if (!pool_) {
+    return;
+  }
+  if (buffer_) {
+    pool_->releaseSlot(PacketBufferPool::Slot{.buffer = buffer_, .raw_packet = packet.release()});
+    buffer_ = nullptr;
+  } else if (packet) {
+    pool_->releaseRawPacket(::std::move(packet));
+  }
+  pool_.reset();
+}
+
 bool Packet::operator==(const Packet& other) const noexcept {
   return (packet->getRawDataLen() == other.packet->getRawDataLen() &&
     ::memcmp(packet->getRawData(), other.packet->getRawData(), packet->getRawDataLen()) == 0);
@@ -153,21 +216,87 @@ bool Packet::operator!=(const Packet& other) const noexcept {
 }
 
 void Packet::parse() noexcept {
-  if (!parsed_packet) {
-    parsed_packet = ::std::make_unique<::pcpp::Packet>(packet.get());
-  }
-  VERIFY(parsed_packet, "Can't parse packet");
+  getView();
+  getParsedPacket();
 }
 
 Packet Packet::copy() const noexcept {
   return Packet{*packet};
 }
 
+Packet Packet::copyPrefix(size_t length) const noexcept {
+  const int prefix_length = static_cast<int>(::std::min(length, static_cast<size_t>(packet->getRawDataLen())));
+  ::pcpp::RawPacket prefix{packet->getRawData(), prefix_length, packet->getPacketTimeStamp(), false,
+      packet->getLinkLayerType()};
+  prefix.setRawData(packet->getRawData(), prefix_length, packet->getPacketTimeStamp(),
+      packet->getLinkLayerType(), packet->getFrameLength());
+  return Packet{prefix};
+}
+
+SharedPacket Packet::share() const noexcept {
+  if (shared_) {
+    return shared_;
+  }
+  if (buffer_) {
+    // Буфер из пула переходит общему владельцу, оболочка остается у пакета
+    holder_ = ::std::shared_ptr<const void>(buffer_, [pool = pool_](const void* buffer) {
+      pool->releaseBuffer(static_cast<byte*>(const_cast<void*>(buffer)));
+    });
+    buffer_ = nullptr;
+  } else if (!holder_ || external_) {
+    // Внешний буфер принадлежит источнику, который ждет его возврата, поэтому кадр копируется
+    shared_ = ::std::make_shared<const Packet>(copy());
+    return shared_;
+  }
+
+  Packet shared{packet->getRawData(), static_cast<size_t>(packet->getRawDataLen()),
+      packet->getPacketTimeStamp(), packet->getLinkLayerType(), holder_};
+  shared.packet->setRawData(packet->getRawData(), packet->getRawDataLen(), packet->getPacketTimeStamp(),
+      packet->getLinkLayerType(), packet->getFrameLength());
+  shared.external_ = false;
+  shared.alerted = alerted;
+  shared.view_ = view_;
+  shared.view_ready_ = view_ready_;
+  shared_ = ::std::make_shared<const Packet>(::std::move(shared));
+  return shared_;
+}
+
+SharedPacket Packet::retain(::std::optional<size_t> payload_prefix) const noexcept {
+  const auto& view = getView();
+  if (!payload_prefix || !view.l4_offset) {
+    return share();
+  }
+  const size_t headers_length = static_cast<size_t>(view.payload.data() - packet->getRawData());
+  const size_t retained_length = headers_length + ::std::min(view.payload.size(), *payload_prefix);
+  if (retained_length >= static_cast<size_t>(packet->getRawDataLen())) {
+    return share();
+  }
+  return ::std::make_shared<const Packet>(copyPrefix(retained_length));
+}
+
 const ::pcpp::Packet& Packet::getParsedPacket() const noexcept {
+  if (!parsed_packet) {
+    parsed_packet = ::std::make_unique<::pcpp::Packet>(packet.get());
+  }
   VERIFY(parsed_packet, "Can't parse packet");
   return *parsed_packet;
 }
 
+const PacketView& Packet::getView() const noexcept {
+  if (view_ready_) {
+    return view_;
+  }
+  return getView(selectLinkDecoder(packet->getLinkLayerType()));
+}
+
+const PacketView& Packet::getView(LinkDecoder decoder) const noexcept {
+  if (!view_ready_) {
+    decoder(packet->getRawData(), static_cast<size_t>(packet->getRawDataLen()), view_);
+    view_ready_ = true;
+  }
+  return view_;
+}
+
 
 Alert::Alert(const ::std::string& message) noexcept
   : message_{message}
@@ -198,6 +327,23 @@ Event::EventType Event::stringToEventType(const std::string& event) noexcept {
 }
 
 
+::std::string Signature::getCaptureFilter() const noexcept {
+  return {};
+}
+
+bool Signature::fillBlueprint(PacketBlueprint& /* blueprint */) const noexcept {
+  return false;
+}
+
+size_t Signature::getInspectedLength() const noexcept {
+  return 0;
+}
+
+bool Signature::usesHeaders() const noexcept {
+  return true;
+}
+
+
 Rule::Rule(const ::std::string& name, const Event::EventType type) noexcept
   : name_{name}
   , type_{type}
@@ -224,6 +370,51 @@ bool Rule::check(const Packet& packet) const noexcept {
   return true;
 }
 
+::std::string Rule::getCaptureFilter() const noexcept {
+  ::std::string filter;
+  for (const auto& sig: signatures_) {
+    const auto sig_filter = sig->getCaptureFilter();
+    if (sig_filter.empty()) {
+      continue;
+    }
+    filter += (filter.empty() ? "(" : " and (") + sig_filter + ")";
+  }
+  return filter;
+}
+
+bool Rule::fillBlueprint(PacketBlueprint& blueprint) const noexcept {
+  for (const auto& sig: signatures_) {
+    if (!sig->fillBlueprint(blueprint)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t Rule::getInspectedLength() const noexcept {
+  if (type_ == Event::EventType::SaveToPcap) {
+    return 0;
+  }
+  size_t length = 0;
+  for (const auto& sig: signatures_) {
+    const size_t sig_length = sig->getInspectedLength();
+    if (!sig_length) {
+      return 0;
+    }
+    length = ::std::max(length, sig_length);
+  }
+  return length;
+}
+
+bool Rule::usesHeaders() const noexcept {
+  for (const auto& sig: signatures_) {
+    if (sig->usesHeaders()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Rule::operator==(const Rule& other) const noexcept {
   if (name_ != other.name_) {
     return false;
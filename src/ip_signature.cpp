@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <unordered_set>
 #include <sstream>
@@ -9,6 +10,7 @@
 
 #include "internal_structs.h"
 #include "ip_signature.h"
+#include "packet_blueprint.h"
 
 
 namespace flow_inspector::internal {
@@ -59,17 +61,14 @@ IPSignature::IPSignature(const ::std::unordered_set<::std::pair<uint32_t, uint32
   , dst_ip_masks_(dstIpMasks.begin(), dstIpMasks.end()) {}
 
 bool IPSignature::check(const Packet& packet) const noexcept {
-  const auto& pcpp_packet = packet.getParsedPacket();
-  const auto ip_layer = pcpp_packet.getLayerOfType<pcpp::IPv4Layer>();
-  if (!ip_layer) {
+  // Проверяется самый внутренний IP-заголовок, туннельные уже сняты
+  const auto& view = packet.getView();
+  if (view.ip_version != 4) {
     return false;
   }
 
-  uint32_t srcIp = swapOctets(ip_layer->getSrcIPv4Address().toInt());
-  uint32_t dstIp = swapOctets(ip_layer->getDstIPv4Address().toInt());
-
-  bool src_match = src_ip_masks_.empty() || matchIPWithMasks(srcIp, src_ip_masks_);
-  bool dst_match = dst_ip_masks_.empty() || matchIPWithMasks(dstIp, dst_ip_masks_);
+  bool src_match = src_ip_masks_.empty() || matchIPWithMasks(view.src_ip, src_ip_masks_);
+  bool dst_match = dst_ip_masks_.empty() || matchIPWithMasks(view.dst_ip, dst_ip_masks_);
 
   return src_match && dst_match;
 }
@@ -93,6 +92,43 @@ size_t IPSignature::hash() const noexcept {
   return hash_val;
 }
 
+::std::string IPSignature::getCaptureFilter() const noexcept {
+  auto masks_filter = [](const char* direction, const auto& ipMasks) {
+    ::std::string filter;
+    for (const auto& [networkIp, mask] : ipMasks) {
+      if (!filter.empty()) {
+        filter += " or ";
+      }
+      filter += ::std::string{direction} + " net "
+          + adressToString(networkIp & mask, __builtin_popcount(mask));
+    }
+    return ipMasks.size() > 1 ? "(" + filter + ")" : filter;
+  };
+
+  ::std::string filter = "ip";
+  if (!src_ip_masks_.empty()) {
+    filter += " and " + masks_filter("src", src_ip_masks_);
+  }
+  if (!dst_ip_masks_.empty()) {
+    filter += " and " + masks_filter("dst", dst_ip_masks_);
+  }
+  return filter;
+}
+
+bool IPSignature::fillBlueprint(PacketBlueprint& blueprint) const noexcept {
+  if (!src_ip_masks_.empty()) {
+    blueprint.src_ip = ::std::min_element(src_ip_masks_.begin(), src_ip_masks_.end())->first;
+  }
+  if (!dst_ip_masks_.empty()) {
+    blueprint.dst_ip = ::std::min_element(dst_ip_masks_.begin(), dst_ip_masks_.end())->first;
+  }
+  return true;
+}
+
+size_t IPSignature::getInspectedLength() const noexcept {
+  return kMaxLinkHeaderSize + kMaxTunnelsHeaderSize + kMaxIpHeaderSize;
+}
+
 ::std::unique_ptr<Signature> IPSignature::createIPSignature(
     const ::std::string& initString) noexcept {
   ::std::unordered_set<::std::pair<uint32_t, uint32_t>> src_ip_masks;
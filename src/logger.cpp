@@ -37,7 +37,7 @@ void Logger::logPacket(internal::Packet packet) noexcept {
   if (log_level_ <= LogLevel::INFO) {
     logEvent(internal::LogEntry{
       .timestamp = getTime(),
-      .packet = ::std::move(packet),
+      .packet = ::std::make_shared<const internal::Packet>(::std::move(packet)),
     });
   }
 }
@@ -30,6 +30,5 @@ int main(int argc, char **argv) {
   ::std::signal(SIGINT, signal_handler);
   ::std::signal(SIGHUP, sighup_handler);
 
-  cli.start();
-  return 0;
+  return cli.start() ? 0 : 1;
 }
\ No newline at end of file
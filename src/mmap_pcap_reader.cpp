@@ -0,0 +1,65 @@
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "mmap_pcap_reader.h"
+#include "pcap_file_format.h"
+
+
+namespace flow_inspector {
+
+
+void MmapPcapReader::setFilename(const ::std::string& filename) noexcept {
+  input_file_ = filename;
+}
+
+void MmapPcapReader::startReading() noexcept {
+  auto file = internal::mapPcapFile(input_file_);
+  if (!file) {
+    return;
+  }
+
+  // Пакеты ссылаются на отображение, оно освобождается вместе с последним из них
+  ::std::shared_ptr<const void> holder(file, file->data);
+  size_t offset = internal::kPcapFileHeaderSize;
+  internal::PcapRecord record;
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
+  while (!isDoneReading()) {
+    const size_t record_size = internal::parsePcapRecord(
+        file->data + offset, file->size - offset, file->info, record);
+    if (!record_size) {
+      break;
+    }
+    batch.emplace_back(record.data, record.captured_length, record.timestamp, file->info.link_type, holder);
+    if (batch.size() == kBatchSize) {
+      flushBatch(batch);
+    }
+    offset += record_size;
+  }
+  flushBatch(batch);
+  if (offset < file->size && !isDoneReading()) {
+    ::std::cerr << "Pcap file " << input_file_ << " is truncated at offset " << offset << ::std::endl;
+  }
+}
+
+void MmapPcapReader::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType MmapPcapReader::getLinkLayerType() noexcept {
+  internal::PcapFileInfo info;
+  if (!internal::readPcapFileInfo(input_file_, info)) {
+    ::std::filesystem::path current_path = ::std::filesystem::current_path();
+    ::std::cerr << "Error opening pcap file: " << input_file_ << ::std::endl;
+    ::std::cerr << "Current directory is " << current_path << ::std::endl;
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return info.link_type;
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,158 @@
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "multi_interface_capturer.h"
+
+
+namespace flow_inspector {
+
+
+void MultiInterfaceCapturer::addInterface(
+    const ::std::string& interface_name, ::std::unique_ptr<PacketOrigin> capturer) noexcept {
+  interfaces_.push_back(Interface{interface_name, ::std::move(capturer)});
+}
+
+void MultiInterfaceCapturer::startReading() noexcept {
+  if (!link_types_consistent_) {
+    markFailed();
+    return;
+  }
+
+  // Все интерфейсы передают пакеты в один анализатор, поэтому обработчики общие
+  for (auto& interface : interfaces_) {
+    interface.capturer->setProcessor([this](internal::Packet packet) {
+      processPacket(::std::move(packet));
+    });
+    interface.capturer->setBatchProcessor([this](::std::span<internal::Packet> packets) {
+      processPackets(packets);
+    });
+  }
+  applyCaptureFilter();
+
+  running_count_.store(interfaces_.size());
+  ::std::vector<::std::thread> threads;
+  for (auto& interface : interfaces_) {
+    threads.emplace_back([this, &interface] {
+      interface.capturer->startReading();
+      running_count_.fetch_sub(1);
+    });
+  }
+  // Захват только части интерфейсов незаметно оставил бы часть трафика без анализа,
+  // поэтому ошибка на одном интерфейсе останавливает все остальные
+  const Interface* failed = nullptr;
+  while (!isDoneReading() && running_count_.load() > 0 && !(failed = findFailedInterface())) {
+    ::std::this_thread::sleep_for(kPollInterval);
+    applyCaptureFilter();
+    updateStatistics();
+  }
+  for (auto& interface : interfaces_) {
+    interface.capturer->stopReading();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  updateStatistics();
+  if (failed || (failed = findFailedInterface())) {
+    ::std::cerr << "Capture on " << failed->name << " failed, stopped capturing on all interfaces" << ::std::endl;
+    markFailed();
+  }
+}
+
+const MultiInterfaceCapturer::Interface* MultiInterfaceCapturer::findFailedInterface() const noexcept {
+  for (const auto& interface : interfaces_) {
+    if (interface.capturer->hasFailed()) {
+      return &interface;
+    }
+  }
+  return nullptr;
+}
+
+void MultiInterfaceCapturer::applyCaptureFilter() noexcept {
+  ::std::string filter;
+  uint32_t snapshot_length = 0;
+  if (!takeCaptureFilter(filter, snapshot_length)) {
+    return;
+  }
+  for (auto& interface : interfaces_) {
+    interface.capturer->setCaptureFilter(filter);
+    interface.capturer->setSnapshotLength(snapshot_length);
+  }
+}
+
+void MultiInterfaceCapturer::updateStatistics() noexcept {
+  CaptureStatistics total;
+  bool has_statistics = false;
+  for (auto& interface : interfaces_) {
+    CaptureStatistics statistics;
+    if (interface.capturer->getCaptureStatistics(statistics)) {
+      total.received += statistics.received;
+      total.kernel_drops += statistics.kernel_drops;
+      total.interface_drops += statistics.interface_drops;
+      total.stalls += statistics.stalls;
+      has_statistics = true;
+    }
+  }
+  if (has_statistics) {
+    setCaptureStatistics(total);
+  }
+}
+
+void MultiInterfaceCapturer::internalStopReading() noexcept {
+  for (auto& interface : interfaces_) {
+    interface.capturer->stopReading();
+  }
+}
+
+bool MultiInterfaceCapturer::hasOwnWorkers() const noexcept {
+  return !interfaces_.empty() && interfaces_.front().capturer->hasOwnWorkers();
+}
+
+::pcpp::LinkLayerType MultiInterfaceCapturer::getLinkLayerType() noexcept {
+  if (interfaces_.empty()) {
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  // Сохраненные пакеты пишутся в один файл, а у файла pcap один тип канального уровня
+  const auto link_type = interfaces_.front().capturer->getLinkLayerType();
+  for (size_t i = 1; i < interfaces_.size(); ++i) {
+    auto& interface = interfaces_[i];
+    const auto interface_link_type = interface.capturer->getLinkLayerType();
+    if (interface_link_type != link_type) {
+      ::std::cerr << "Couldn't capture from interfaces with different link types: "
+          << interfaces_.front().name << " (" << link_type << "), "
+          << interface.name << " (" << interface_link_type << ")" << ::std::endl;
+      link_types_consistent_ = false;
+    }
+  }
+  return link_type;
+}
+
+::std::string MultiInterfaceCapturer::getStatistics() noexcept {
+  ::std::ostringstream result;
+  for (auto& interface : interfaces_) {
+    if (result.tellp() > 0) {
+      result << "\n";
+    }
+    result << "Interface " << interface.name << ":";
+    CaptureStatistics statistics;
+    if (interface.capturer->getCaptureStatistics(statistics)) {
+      result << " received " << statistics.received
+          << ", dropped by kernel " << statistics.kernel_drops
+          << ", dropped by interface " << statistics.interface_drops;
+    } else {
+      result << " no statistics";
+    }
+    const auto capturer_statistics = interface.capturer->getStatistics();
+    if (!capturer_statistics.empty()) {
+      result << "\n" << capturer_statistics;
+    }
+  }
+  return result.str();
+}
+
+
+}  // namespace flow_inspector
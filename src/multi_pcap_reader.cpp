@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glob.h>
+
+#include "RawPacket.h"
+#include "PcapFileDevice.h"
+
+#include "internal_structs.h"
+#include "multi_pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+bool timestampLess(const timespec& lhs, const timespec& rhs) noexcept {
+  return lhs.tv_sec < rhs.tv_sec || (lhs.tv_sec == rhs.tv_sec && lhs.tv_nsec < rhs.tv_nsec);
+}
+
+
+}  // namespace
+
+
+struct MultiPcapReader::Stream {
+  ::std::string filename;
+  timespec first_timestamp{};
+  ::std::unique_ptr<::pcpp::IFileReaderDevice> reader;
+
+  ::std::mutex mutex;
+  ::std::condition_variable condition;
+  ::std::deque<internal::Packet> packets;
+  bool finished{false};
+  bool scheduled{false};
+};
+
+
+MultiPcapReader::MultiPcapReader() noexcept {}
+
+MultiPcapReader::~MultiPcapReader() noexcept {}
+
+::std::vector<::std::string> MultiPcapReader::resolveInputs(const ::std::string& input) noexcept {
+  ::std::vector<::std::string> result;
+  ::std::stringstream items{input};
+  ::std::string item;
+  while (::std::getline(items, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    ::std::error_code error;
+    if (::std::filesystem::is_directory(item, error)) {
+      ::std::vector<::std::string> directory_files;
+      for (const auto& entry : ::std::filesystem::directory_iterator(item, error)) {
+        if (entry.is_regular_file(error)) {
+          directory_files.push_back(entry.path().string());
+        }
+      }
+      ::std::sort(directory_files.begin(), directory_files.end());
+      result.insert(result.end(), directory_files.begin(), directory_files.end());
+      continue;
+    }
+    if (item.find_first_of("*?[") != ::std::string::npos) {
+      glob_t matches{};
+      if (::glob(item.c_str(), 0, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+          result.emplace_back(matches.gl_pathv[i]);
+        }
+      }
+      ::globfree(&matches);
+      continue;
+    }
+    result.push_back(item);
+  }
+  return result;
+}
+
+void MultiPcapReader::setFilenames(::std::vector<::std::string> filenames) noexcept {
+  input_files_ = ::std::move(filenames);
+}
+
+void MultiPcapReader::setReadersCount(uint8_t readers_count) noexcept {
+  readers_count_ = readers_count ? readers_count : 1;
+}
+
+void MultiPcapReader::startReading() noexcept {
+  if (!link_types_consistent_) {
+    return;
+  }
+
+  // Файлы упорядочиваются по первой метке времени и подключаются к слиянию по мере надобности
+  ::std::vector<::std::unique_ptr<Stream>> streams;
+  for (const auto& filename : input_files_) {
+    ::std::unique_ptr<::pcpp::IFileReaderDevice> reader{::pcpp::IFileReaderDevice::getReader(filename)};
+    ::pcpp::RawPacket first_packet;
+    if (!reader->open()) {
+      ::std::cerr << "Error opening pcap file: " << filename << ::std::endl;
+      continue;
+    }
+    if (!reader->getNextPacket(first_packet)) {
+      continue;
+    }
+    auto stream = ::std::make_unique<Stream>();
+    stream->filename = filename;
+    stream->first_timestamp = first_packet.getPacketTimeStamp();
+    streams.push_back(::std::move(stream));
+  }
+  ::std::stable_sort(streams.begin(), streams.end(), [](const auto& lhs, const auto& rhs) {
+    return timestampLess(lhs->first_timestamp, rhs->first_timestamp);
+  });
+
+  ::std::vector<::std::thread> readers;
+  for (uint8_t i = 0; i < readers_count_; ++i) {
+    readers.emplace_back(&MultiPcapReader::readStreams, this);
+  }
+
+  struct Head {
+    timespec timestamp;
+    size_t stream_index;
+    internal::Packet packet;
+  };
+  auto later = [](const Head& lhs, const Head& rhs) {
+    if (lhs.timestamp.tv_sec != rhs.timestamp.tv_sec || lhs.timestamp.tv_nsec != rhs.timestamp.tv_nsec) {
+      return timestampLess(rhs.timestamp, lhs.timestamp);
+    }
+    return lhs.stream_index > rhs.stream_index;
+  };
+  ::std::vector<Head> heads;
+  auto push_head = [&heads, &later](Head head) {
+    heads.push_back(::std::move(head));
+    ::std::push_heap(heads.begin(), heads.end(), later);
+  };
+
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
+  size_t next_stream = 0;
+  size_t active_streams = 0;
+  auto activate = [&]() {
+    auto& stream = *streams[next_stream];
+    stream.scheduled = true;
+    scheduleRefill(stream);
+    internal::Packet packet;
+    if (takePacket(stream, packet)) {
+      push_head(Head{packet.packet->getPacketTimeStamp(), next_stream, ::std::move(packet)});
+      ++active_streams;
+    }
+    ++next_stream;
+  };
+
+  while (!isDoneReading()) {
+    // Подключаются все файлы, которые могут содержать пакет раньше текущего минимума,
+    // и еще несколько следующих, чтобы читатели успевали заполнить их заранее
+    while (next_stream < streams.size()
+        && (heads.empty() || active_streams < readers_count_
+            || !timestampLess(heads.front().timestamp, streams[next_stream]->first_timestamp))) {
+      activate();
+    }
+    if (heads.empty()) {
+      break;
+    }
+
+    ::std::pop_heap(heads.begin(), heads.end(), later);
+    Head head = ::std::move(heads.back());
+    heads.pop_back();
+    auto& stream = *streams[head.stream_index];
+    batch.push_back(::std::move(head.packet));
+    if (batch.size() == kBatchSize) {
+      flushBatch(batch);
+    }
+
+    internal::Packet packet;
+    if (takePacket(stream, packet)) {
+      push_head(Head{packet.packet->getPacketTimeStamp(), head.stream_index, ::std::move(packet)});
+    } else {
+      --active_streams;
+      // При остановке пакеты кончаются и посреди пополнения, пока читатель еще работает с файлом,
+      // поэтому такой файл закрывается только после завершения потоков чтения
+      ::std::lock_guard<::std::mutex> lock(stream.mutex);
+      if (stream.finished && !stream.scheduled) {
+        stream.reader.reset();
+      }
+    }
+  }
+  flushBatch(batch);
+
+  {
+    ::std::lock_guard<::std::mutex> lock(refill_mutex_);
+    refill_queue_.push_back(nullptr);
+  }
+  refill_condition_.notify_all();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  refill_queue_.clear();
+}
+
+void MultiPcapReader::scheduleRefill(Stream& stream) noexcept {
+  {
+    ::std::lock_guard<::std::mutex> lock(refill_mutex_);
+    refill_queue_.push_back(&stream);
+  }
+  refill_condition_.notify_one();
+}
+
+bool MultiPcapReader::takePacket(Stream& stream, internal::Packet& packet) noexcept {
+  ::std::unique_lock<::std::mutex> lock(stream.mutex);
+  while (stream.packets.empty() && !stream.finished && !isDoneReading()) {
+    stream.condition.wait_for(lock, kWaitTime);
+  }
+  if (stream.packets.empty()) {
+    return false;
+  }
+  packet = ::std::move(stream.packets.front());
+  stream.packets.pop_front();
+  if (!stream.finished && !stream.scheduled && stream.packets.size() < kStreamCapacity / 2) {
+    stream.scheduled = true;
+    lock.unlock();
+    scheduleRefill(stream);
+  }
+  return true;
+}
+
+void MultiPcapReader::readStreams() noexcept {
+  while (true) {
+    Stream* stream;
+    {
+      ::std::unique_lock<::std::mutex> lock(refill_mutex_);
+      refill_condition_.wait(lock, [this]() {
+        return !refill_queue_.empty();
+      });
+      stream = refill_queue_.front();
+      if (!stream) {
+        // Признак завершения остается в очереди для остальных читателей
+        refill_condition_.notify_all();
+        return;
+      }
+      refill_queue_.pop_front();
+    }
+
+    if (!stream->reader) {
+      stream->reader.reset(::pcpp::IFileReaderDevice::getReader(stream->filename));
+      if (!stream->reader->open()) {
+        ::std::cerr << "Error opening pcap file: " << stream->filename << ::std::endl;
+      }
+    }
+    ::std::vector<internal::Packet> batch;
+    ::pcpp::RawPacket raw_packet;
+    bool finished = false;
+    while (batch.size() < kRefillBatch && !isDoneReading()) {
+      if (!stream->reader->getNextPacket(raw_packet)) {
+        finished = true;
+        break;
+      }
+      batch.emplace_back(raw_packet);
+    }
+
+    bool reschedule = false;
+    {
+      ::std::lock_guard<::std::mutex> lock(stream->mutex);
+      for (auto& packet : batch) {
+        stream->packets.push_back(::std::move(packet));
+      }
+      stream->finished = finished || isDoneReading();
+      reschedule = !stream->finished && stream->packets.size() < kStreamCapacity;
+      stream->scheduled = reschedule;
+    }
+    stream->condition.notify_all();
+    if (reschedule) {
+      scheduleRefill(*stream);
+    }
+  }
+}
+
+void MultiPcapReader::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType MultiPcapReader::getLinkLayerType() noexcept {
+  // Сохраненные пакеты пишутся в один файл, а у файла pcap один тип канального уровня
+  ::std::optional<::pcpp::LinkLayerType> link_type;
+  ::std::string link_type_file;
+  for (const auto& filename : input_files_) {
+    ::std::unique_ptr<::pcpp::IFileReaderDevice> reader{::pcpp::IFileReaderDevice::getReader(filename)};
+    ::pcpp::RawPacket first_packet;
+    if (!reader->open() || !reader->getNextPacket(first_packet)) {
+      continue;
+    }
+    if (!link_type) {
+      link_type = first_packet.getLinkLayerType();
+      link_type_file = filename;
+    } else if (first_packet.getLinkLayerType() != *link_type) {
+      ::std::cerr << "Couldn't merge pcap files with different link types: "
+          << link_type_file << " (" << *link_type << "), "
+          << filename << " (" << first_packet.getLinkLayerType() << ")" << ::std::endl;
+      link_types_consistent_ = false;
+    }
+  }
+  if (!link_type) {
+    ::std::cerr << "Couldn't read any of " << input_files_.size() << " pcap files" << ::std::endl;
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return *link_type;
+}
+
+
+}  // namespace flow_inspector
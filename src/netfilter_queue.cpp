@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nfnetlink_queue.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "netfilter_queue.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr int kAckTimeoutMs{1000};
+constexpr uint32_t kMaxCopyRange{0xffff};
+
+
+class MessageBuilder {
+ public:
+  explicit MessageBuilder(::std::vector<byte>& buffer) noexcept
+    : buffer_{buffer}
+  {}
+
+  void begin(uint16_t type, uint16_t flags, uint32_t sequence, uint16_t queue_number) noexcept {
+    start_ = buffer_.size();
+    buffer_.resize(start_ + NLMSG_HDRLEN + NLMSG_ALIGN(sizeof(nfgenmsg)));
+    nlmsghdr header{
+      .nlmsg_len = 0,
+      .nlmsg_type = static_cast<uint16_t>((NFNL_SUBSYS_QUEUE << 8) | type),
+      .nlmsg_flags = static_cast<uint16_t>(NLM_F_REQUEST | flags),
+      .nlmsg_seq = sequence,
+      .nlmsg_pid = 0,
+    };
+    nfgenmsg generic{
+      .nfgen_family = AF_UNSPEC,
+      .version = NFNETLINK_V0,
+      .res_id = htons(queue_number),
+    };
+    ::std::memcpy(buffer_.data() + start_, &header, sizeof(header));
+    ::std::memcpy(buffer_.data() + start_ + NLMSG_HDRLEN, &generic, sizeof(generic));
+  }
+
+  void addAttribute(uint16_t type, const void* data, size_t length) noexcept {
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + NLA_ALIGN(NLA_HDRLEN + length));
+    nlattr attribute{
+      .nla_len = static_cast<uint16_t>(NLA_HDRLEN + length),
+      .nla_type = type,
+    };
+    ::std::memcpy(buffer_.data() + offset, &attribute, sizeof(attribute));
+    ::std::memcpy(buffer_.data() + offset + NLA_HDRLEN, data, length);
+  }
+
+  void end() noexcept {
+    const auto length = static_cast<uint32_t>(buffer_.size() - start_);
+    ::std::memcpy(buffer_.data() + start_ + offsetof(nlmsghdr, nlmsg_len), &length, sizeof(length));
+  }
+
+ private:
+  ::std::vector<byte>& buffer_;
+  size_t start_{0};
+};
+
+
+}  // namespace
+
+
+NetfilterQueue::NetfilterQueue() noexcept {}
+
+NetfilterQueue::~NetfilterQueue() noexcept {
+  close();
+}
+
+bool NetfilterQueue::open(uint16_t queue_number, const Config& config) noexcept {
+  close();
+  config_ = config;
+  queue_number_ = queue_number;
+
+  fd_ = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER);
+  if (fd_ < 0) {
+    ::std::cerr << "Couldn't create netlink socket: " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  sockaddr_nl address{};
+  address.nl_family = AF_NETLINK;
+  if (::bind(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    ::std::cerr << "Couldn't bind netlink socket: " << ::std::strerror(errno) << ::std::endl;
+    close();
+    return false;
+  }
+  // Буфер сокета сглаживает всплески, пока обработчики заняты пачкой; переполнение учитывает ядро
+  int receive_buffer = static_cast<int>(config_.buffer_size * 4);
+  if (::setsockopt(fd_, SOL_SOCKET, SO_RCVBUFFORCE, &receive_buffer, sizeof(receive_buffer)) < 0) {
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+  }
+  int enabled = 1;
+  ::setsockopt(fd_, SOL_NETLINK, NETLINK_NO_ENOBUFS, &enabled, sizeof(enabled));
+
+  ::std::vector<byte> message;
+  buildBindRequest(message, ++sequence_, queue_number_, config_);
+  if (!sendMessage(message, true)) {
+    ::std::cerr << "Couldn't bind NFQUEUE " << queue_number_ << ::std::endl;
+    close();
+    return false;
+  }
+
+  buffer_ = ::std::make_shared<::std::vector<byte>>(::std::max(config_.buffer_size, kMaxMessageSize));
+  return true;
+}
+
+bool NetfilterQueue::setCopyRange(uint32_t copy_range) noexcept {
+  if (fd_ < 0) {
+    return false;
+  }
+  ::std::vector<byte> message;
+  MessageBuilder builder{message};
+  builder.begin(NFQNL_MSG_CONFIG, 0, ++sequence_, queue_number_);
+  const uint32_t range = copy_range && copy_range < kMaxCopyRange ? copy_range : kMaxCopyRange;
+  nfqnl_msg_config_params params{.copy_range = htonl(range), .copy_mode = NFQNL_COPY_PACKET};
+  builder.addAttribute(NFQA_CFG_PARAMS, &params, sizeof(params));
+  builder.end();
+  return sendMessage(message, false);
+}
+
+void NetfilterQueue::close() noexcept {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+}
+
+bool NetfilterQueue::receive(int timeout_ms, size_t max_packets, const PacketHandler& handler) noexcept {
+  if (fd_ < 0) {
+    return false;
+  }
+  pollfd pfd{.fd = fd_, .events = POLLIN, .revents = 0};
+  const int ready = ::poll(&pfd, 1, timeout_ms);
+  if (ready < 0) {
+    return errno == EINTR;
+  }
+  if (!ready) {
+    return true;
+  }
+
+  if (buffer_.use_count() > 1) {
+    // Пакеты прошлой пачки еще живы (например, сохранены для записи), буфер им остается
+    buffer_ = ::std::make_shared<::std::vector<byte>>(buffer_->size());
+  }
+  timespec now{};
+  ::clock_gettime(CLOCK_REALTIME, &now);
+
+  auto& buffer = *buffer_;
+  size_t used = 0;
+  size_t packets_count = 0;
+  while (packets_count < max_packets && buffer.size() - used >= kMaxMessageSize) {
+    const ssize_t received = ::recv(fd_, buffer.data() + used, buffer.size() - used, MSG_DONTWAIT);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+        break;
+      }
+      ::std::cerr << "Couldn't read NFQUEUE " << queue_number_ << ": " << ::std::strerror(errno) << ::std::endl;
+      return false;
+    }
+
+    packets_count += parsePackets(buffer.data() + used, static_cast<size_t>(received), now, buffer_, handler);
+    used += NLMSG_ALIGN(static_cast<size_t>(received));
+  }
+  return true;
+}
+
+bool NetfilterQueue::sendVerdicts(::std::span<const uint32_t> dropped_ids, uint32_t last_id) noexcept {
+  ::std::vector<byte> message;
+  buildVerdicts(message, sequence_, queue_number_, dropped_ids, last_id);
+  return sendMessage(message, false);
+}
+
+void NetfilterQueue::buildBindRequest(
+    ::std::vector<byte>& message, uint32_t sequence, uint16_t queue_number, const Config& config) noexcept {
+  MessageBuilder builder{message};
+  builder.begin(NFQNL_MSG_CONFIG, NLM_F_ACK, sequence, queue_number);
+  nfqnl_msg_config_cmd command{.command = NFQNL_CFG_CMD_BIND, ._pad = 0, .pf = 0};
+  builder.addAttribute(NFQA_CFG_CMD, &command, sizeof(command));
+  nfqnl_msg_config_params params{.copy_range = htonl(kMaxCopyRange), .copy_mode = NFQNL_COPY_PACKET};
+  builder.addAttribute(NFQA_CFG_PARAMS, &params, sizeof(params));
+  const uint32_t max_length = htonl(config.max_length);
+  builder.addAttribute(NFQA_CFG_QUEUE_MAXLEN, &max_length, sizeof(max_length));
+  // GSO-пакеты приходят целиком, без программной сегментации в ядре
+  const uint32_t mask = htonl(NFQA_CFG_F_FAIL_OPEN | NFQA_CFG_F_GSO);
+  const uint32_t flags = htonl((config.fail_open ? NFQA_CFG_F_FAIL_OPEN : 0) | NFQA_CFG_F_GSO);
+  builder.addAttribute(NFQA_CFG_MASK, &mask, sizeof(mask));
+  builder.addAttribute(NFQA_CFG_FLAGS, &flags, sizeof(flags));
+  builder.end();
+}
+
+void NetfilterQueue::buildVerdicts(::std::vector<byte>& message, uint32_t& sequence, uint16_t queue_number,
+    ::std::span<const uint32_t> dropped_ids, uint32_t last_id) noexcept {
+  message.reserve(message.size() + (dropped_ids.size() + 1) * 64);
+  MessageBuilder builder{message};
+  for (const auto id : dropped_ids) {
+    builder.begin(NFQNL_MSG_VERDICT, 0, ++sequence, queue_number);
+    nfqnl_msg_verdict_hdr verdict{.verdict = htonl(NF_DROP), .id = htonl(id)};
+    builder.addAttribute(NFQA_VERDICT_HDR, &verdict, sizeof(verdict));
+    builder.end();
+  }
+  // Пакетный вердикт применяется ко всем ожидающим пакетам с идентификатором не больше заданного
+  builder.begin(NFQNL_MSG_VERDICT_BATCH, 0, ++sequence, queue_number);
+  nfqnl_msg_verdict_hdr verdict{.verdict = htonl(NF_ACCEPT), .id = htonl(last_id)};
+  builder.addAttribute(NFQA_VERDICT_HDR, &verdict, sizeof(verdict));
+  builder.end();
+}
+
+size_t NetfilterQueue::parsePackets(const byte* data, size_t length, const timespec& now,
+    const ::std::shared_ptr<const void>& holder, const PacketHandler& handler) noexcept {
+  size_t packets_count = 0;
+  const auto* header = reinterpret_cast<const nlmsghdr*>(data);
+  int remaining = static_cast<int>(length);
+  for (; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+    if (header->nlmsg_type == NLMSG_ERROR) {
+      const auto* error = reinterpret_cast<const nlmsgerr*>(NLMSG_DATA(header));
+      if (error->error) {
+        ::std::cerr << "NFQUEUE request failed: " << ::std::strerror(-error->error) << ::std::endl;
+      }
+      continue;
+    }
+    if (header->nlmsg_type != ((NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_PACKET)) {
+      continue;
+    }
+
+    const size_t attributes_offset = NLMSG_HDRLEN + NLMSG_ALIGN(sizeof(nfgenmsg));
+    if (header->nlmsg_len < attributes_offset) {
+      continue;
+    }
+    const auto* attributes = reinterpret_cast<const byte*>(header) + attributes_offset;
+    size_t attributes_length = header->nlmsg_len - attributes_offset;
+    bool has_id = false;
+    uint32_t packet_id = 0;
+    const byte* payload = nullptr;
+    size_t payload_length = 0;
+    timespec timestamp = now;
+    while (attributes_length >= NLA_HDRLEN) {
+      nlattr attribute;
+      ::std::memcpy(&attribute, attributes, sizeof(attribute));
+      if (attribute.nla_len < NLA_HDRLEN || attribute.nla_len > attributes_length) {
+        break;
+      }
+      const byte* attribute_data = attributes + NLA_HDRLEN;
+      const size_t attribute_length = attribute.nla_len - NLA_HDRLEN;
+      switch (attribute.nla_type & NLA_TYPE_MASK) {
+        case NFQA_PACKET_HDR: {
+          if (attribute_length < sizeof(nfqnl_msg_packet_hdr)) {
+            break;
+          }
+          nfqnl_msg_packet_hdr packet_header;
+          ::std::memcpy(&packet_header, attribute_data, sizeof(packet_header));
+          packet_id = ntohl(packet_header.packet_id);
+          has_id = true;
+          break;
+        }
+        case NFQA_PAYLOAD:
+          payload = attribute_data;
+          payload_length = attribute_length;
+          break;
+        case NFQA_TIMESTAMP: {
+          if (attribute_length < sizeof(nfqnl_msg_packet_timestamp)) {
+            break;
+          }
+          nfqnl_msg_packet_timestamp packet_timestamp;
+          ::std::memcpy(&packet_timestamp, attribute_data, sizeof(packet_timestamp));
+          timestamp.tv_sec = static_cast<time_t>(be64toh(packet_timestamp.sec));
+          timestamp.tv_nsec = static_cast<long>(be64toh(packet_timestamp.usec) * 1000);
+          break;
+        }
+        default:
+          break;
+      }
+      const size_t step = NLA_ALIGN(attribute.nla_len);
+      if (step >= attributes_length) {
+        break;
+      }
+      attributes += step;
+      attributes_length -= step;
+    }
+
+    if (has_id && payload) {
+      handler(packet_id, Packet{payload, payload_length, timestamp, ::pcpp::LinkLayerType::LINKTYPE_RAW, holder});
+      ++packets_count;
+    }
+  }
+  return packets_count;
+}
+
+NetfilterQueue::Statistics NetfilterQueue::getStatistics() const noexcept {
+  Statistics statistics;
+  if (fd_ < 0) {
+    return statistics;
+  }
+  ::std::ifstream file("/proc/net/netfilter/nfnetlink_queue");
+  ::std::string line;
+  while (::std::getline(file, line)) {
+    ::std::istringstream fields(line);
+    uint32_t queue_number = 0, port_id = 0, queue_total = 0, copy_mode = 0, copy_range = 0;
+    uint64_t queue_dropped = 0, user_dropped = 0, id_sequence = 0;
+    if (fields >> queue_number >> port_id >> queue_total >> copy_mode >> copy_range
+        >> queue_dropped >> user_dropped >> id_sequence && queue_number == queue_number_) {
+      statistics.packets = id_sequence;
+      statistics.queued = queue_total;
+      statistics.queue_drops = queue_dropped;
+      statistics.user_drops = user_dropped;
+      break;
+    }
+  }
+  return statistics;
+}
+
+bool NetfilterQueue::sendMessage(const ::std::vector<byte>& message, bool wait_ack) noexcept {
+  sockaddr_nl kernel{};
+  kernel.nl_family = AF_NETLINK;
+  if (::sendto(fd_, message.data(), message.size(), 0,
+      reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0) {
+    ::std::cerr << "Couldn't send to NFQUEUE " << queue_number_ << ": " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  if (!wait_ack) {
+    return true;
+  }
+
+  alignas(nlmsghdr) byte reply[4096];
+  pollfd pfd{.fd = fd_, .events = POLLIN, .revents = 0};
+  while (::poll(&pfd, 1, kAckTimeoutMs) > 0) {
+    const ssize_t received = ::recv(fd_, reply, sizeof(reply), 0);
+    if (received < 0) {
+      break;
+    }
+    auto* header = reinterpret_cast<nlmsghdr*>(reply);
+    int remaining = static_cast<int>(received);
+    for (; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+      if (header->nlmsg_type != NLMSG_ERROR || header->nlmsg_seq != sequence_) {
+        continue;
+      }
+      const auto* error = reinterpret_cast<const nlmsgerr*>(NLMSG_DATA(header));
+      if (error->error) {
+        ::std::cerr << "NFQUEUE " << queue_number_ << " request failed: "
+            << ::std::strerror(-error->error) << ::std::endl;
+        return false;
+      }
+      return true;
+    }
+  }
+  ::std::cerr << "No reply from NFQUEUE " << queue_number_ << ::std::endl;
+  return false;
+}
+
+
+}  // namespace flow_inspector::internal
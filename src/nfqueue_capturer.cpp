@@ -0,0 +1,142 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal_structs.h"
+#include "netfilter_queue.h"
+#include "nfqueue_capturer.h"
+
+
+namespace flow_inspector {
+
+
+void NfqueueCapturer::setNfqueueConfig(const Config& config) noexcept {
+  config_ = config;
+}
+
+void NfqueueCapturer::startReading() noexcept {
+  ::std::vector<::std::unique_ptr<internal::NetfilterQueue>> queues;
+  for (const auto queue_number : config_.queues) {
+    auto queue = ::std::make_unique<internal::NetfilterQueue>();
+    if (!queue->open(queue_number, config_.queue)) {
+      ::std::cerr << "Couldn't open NFQUEUE " << queue_number << ::std::endl;
+      markFailed();
+      return;
+    }
+    queues.push_back(::std::move(queue));
+  }
+
+  // Каждая очередь обслуживается своим потоком, вердикт выносится сразу после анализа пачки
+  ::std::vector<::std::atomic<bool>> saturated(queues.size());
+  ::std::vector<::std::thread> workers;
+  for (size_t i = 0; i < queues.size(); ++i) {
+    workers.emplace_back(&NfqueueCapturer::readQueue, this, ::std::ref(*queues[i]), ::std::cref(saturated[i]));
+  }
+  ::std::string filter;
+  uint32_t snapshot_length = 0;
+  while (!isDoneReading()) {
+    if (takeCaptureFilter(filter, snapshot_length)) {
+      copy_range_.store(snapshot_length, ::std::memory_order_relaxed);
+    }
+    updateStatistics(queues, saturated);
+    ::std::this_thread::sleep_for(::std::chrono::milliseconds(kPollTimeoutMs));
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  updateStatistics(queues, saturated);
+  for (auto& queue : queues) {
+    queue->close();
+  }
+}
+
+void NfqueueCapturer::readQueue(internal::NetfilterQueue& queue, const ::std::atomic<bool>& saturated) noexcept {
+  ::std::vector<internal::Packet> batch;
+  ::std::vector<uint32_t> ids;
+  ::std::vector<uint32_t> dropped_ids;
+  auto handler = [&batch, &ids](uint32_t id, internal::Packet packet) {
+    ids.push_back(id);
+    batch.push_back(::std::move(packet));
+  };
+  // Запросы к очереди нумеруются и отправляются через один сокет, поэтому их шлет только этот поток
+  uint32_t copy_range = 0;
+  while (!isDoneReading()) {
+    if (const auto requested = copy_range_.load(::std::memory_order_relaxed); requested != copy_range) {
+      queue.setCopyRange(requested);
+      copy_range = requested;
+    }
+    if (!queue.receive(kPollTimeoutMs, kBatchSize, handler)) {
+      // Без вердиктов очередь ядра либо пропускает пакеты без анализа, либо отбрасывает весь трафик
+      ::std::cerr << "Verdicts on NFQUEUE stopped, stopping capture" << ::std::endl;
+      markFailed();
+      stopReading();
+      break;
+    }
+    if (batch.empty()) {
+      continue;
+    }
+
+    if (saturated.load(::std::memory_order_relaxed)) {
+      // Обработчик не успевает за очередью: пачка пропускается без анализа, пока очередь не разгрузится
+      queue.sendVerdicts({}, ids.back());
+      bypassed_count_.fetch_add(batch.size(), ::std::memory_order_relaxed);
+      batch.clear();
+      ids.clear();
+      continue;
+    }
+    processPackets(batch);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (batch[i].alerted) {
+        dropped_ids.push_back(ids[i]);
+      }
+    }
+    queue.sendVerdicts(dropped_ids, ids.back());
+    dropped_count_.fetch_add(dropped_ids.size(), ::std::memory_order_relaxed);
+    accepted_count_.fetch_add(batch.size() - dropped_ids.size(), ::std::memory_order_relaxed);
+    batch.clear();
+    ids.clear();
+    dropped_ids.clear();
+  }
+}
+
+void NfqueueCapturer::updateStatistics(const ::std::vector<::std::unique_ptr<internal::NetfilterQueue>>& queues,
+    ::std::vector<::std::atomic<bool>>& saturated) noexcept {
+  CaptureStatistics statistics;
+  for (size_t i = 0; i < queues.size(); ++i) {
+    const auto queue_statistics = queues[i]->getStatistics();
+    statistics.received += queue_statistics.packets;
+    statistics.kernel_drops += queue_statistics.queue_drops + queue_statistics.user_drops;
+    // Очередь в ядре заполняется, когда обработчик не успевает; в режиме fail-open пакеты пропускаются
+    // без анализа раньше, чем ядро начнет их отбрасывать или пропускать без вердикта
+    saturated[i].store(config_.queue.fail_open
+        && queue_statistics.queued * 100 >= uint64_t{config_.queue.max_length} * kSaturationPercent,
+        ::std::memory_order_relaxed);
+  }
+  setCaptureStatistics(statistics);
+}
+
+void NfqueueCapturer::internalStopReading() noexcept {}
+
+bool NfqueueCapturer::hasOwnWorkers() const noexcept {
+  return true;
+}
+
+::pcpp::LinkLayerType NfqueueCapturer::getLinkLayerType() noexcept {
+  return ::pcpp::LinkLayerType::LINKTYPE_RAW;
+}
+
+::std::string NfqueueCapturer::getStatistics() noexcept {
+  ::std::ostringstream result;
+  result << "NFQUEUE: accepted " << accepted_count_.load(::std::memory_order_relaxed)
+      << ", dropped by rules " << dropped_count_.load(::std::memory_order_relaxed)
+      << ", accepted unanalyzed while saturated " << bypassed_count_.load(::std::memory_order_relaxed);
+  return result.str();
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,39 @@
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "pacer.h"
+
+
+namespace flow_inspector::internal {
+
+
+void Pacer::start() noexcept {
+  start_ = Clock::now();
+}
+
+void Pacer::waitUntil(::std::chrono::nanoseconds offset) const noexcept {
+  const auto target = start_ + offset;
+  auto now = Clock::now();
+  if (target - now > kSpinThreshold) {
+    ::std::this_thread::sleep_until(target - kSpinThreshold);
+    now = Clock::now();
+  }
+  while (now < target) {
+    now = Clock::now();
+  }
+}
+
+::std::chrono::nanoseconds Pacer::elapsed() const noexcept {
+  return Clock::now() - start_;
+}
+
+::std::chrono::nanoseconds Pacer::offsetAtRate(uint64_t count, uint64_t per_second) noexcept {
+  // count * 1e9 переполняет uint64 уже после ~1.8e10 событий, поэтому целые секунды считаются отдельно
+  constexpr uint64_t kNanosecondsPerSecond{1'000'000'000};
+  return ::std::chrono::nanoseconds(static_cast<int64_t>(count / per_second * kNanosecondsPerSecond
+      + count % per_second * kNanosecondsPerSecond / per_second));
+}
+
+
+}  // namespace flow_inspector::internal
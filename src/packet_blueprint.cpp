@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "internal_structs.h"
+#include "packet_blueprint.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr size_t kEthernetHeaderSize{14};
+constexpr size_t kIpHeaderSize{20};
+constexpr size_t kTcpHeaderSize{20};
+constexpr size_t kUdpHeaderSize{8};
+constexpr size_t kIcmpHeaderSize{8};
+
+void writeUint16(byte* data, uint16_t value) noexcept {
+  data[0] = static_cast<byte>(value >> 8);
+  data[1] = static_cast<byte>(value);
+}
+
+void writeUint32(byte* data, uint32_t value) noexcept {
+  writeUint16(data, static_cast<uint16_t>(value >> 16));
+  writeUint16(data + 2, static_cast<uint16_t>(value));
+}
+
+uint16_t checksum(const byte* data, size_t size) noexcept {
+  uint32_t sum = 0;
+  for (size_t i = 0; i + 1 < size; i += 2) {
+    sum += (static_cast<uint32_t>(data[i]) << 8) | data[i + 1];
+  }
+  if (size % 2) {
+    sum += static_cast<uint32_t>(data[size - 1]) << 8;
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return static_cast<uint16_t>(~sum);
+}
+
+
+size_t transportHeaderSize(PacketBlueprint::Transport transport) noexcept {
+  switch (transport) {
+    case PacketBlueprint::Transport::UDP:
+      return kUdpHeaderSize;
+    case PacketBlueprint::Transport::ICMP:
+      return kIcmpHeaderSize;
+    default:
+      return kTcpHeaderSize;
+  }
+}
+
+
+}  // namespace
+
+
+size_t PacketBlueprint::headersSize() const noexcept {
+  return kEthernetHeaderSize + kIpHeaderSize
+      + transportHeaderSize(transport.value_or(Transport::TCP));
+}
+
+
+::std::vector<byte> buildFrame(
+    const PacketBlueprint& blueprint, size_t frame_size, byte filler) noexcept {
+  const auto transport = blueprint.transport.value_or(PacketBlueprint::Transport::TCP);
+  const size_t transport_header_size = transportHeaderSize(transport);
+  uint8_t protocol = IPPROTO_TCP;
+  if (transport == PacketBlueprint::Transport::UDP) {
+    protocol = IPPROTO_UDP;
+  } else if (transport == PacketBlueprint::Transport::ICMP) {
+    protocol = IPPROTO_ICMP;
+  }
+
+  // Байты по смещениям могут выходить за нагрузку, поэтому размер кадра определяется до записи длин в заголовки
+  const size_t headers_size = blueprint.headersSize();
+  size_t frame_length = headers_size + ::std::max(blueprint.payload.size(),
+      frame_size > headers_size ? frame_size - headers_size : 0);
+  for (const auto& [offset, bytes] : blueprint.raw_bytes) {
+    frame_length = ::std::max(frame_length, offset + bytes.size());
+  }
+  const size_t payload_size = frame_length - headers_size;
+  ::std::vector<byte> frame(frame_length, 0);
+
+  byte* ethernet = frame.data();
+  // Локально администрируемые MAC-адреса
+  ethernet[0] = 0x02;
+  ethernet[5] = 0x02;
+  ethernet[6] = 0x02;
+  ethernet[11] = 0x01;
+  writeUint16(ethernet + 12, 0x0800);
+
+  byte* ip = ethernet + kEthernetHeaderSize;
+  ip[0] = 0x45;
+  writeUint16(ip + 6, 0x4000);
+  ip[8] = 64;
+  ip[9] = protocol;
+  writeUint32(ip + 12, blueprint.src_ip);
+  writeUint32(ip + 16, blueprint.dst_ip);
+
+  byte* transport_header = ip + kIpHeaderSize;
+  if (transport == PacketBlueprint::Transport::TCP) {
+    writeUint16(transport_header, blueprint.src_port);
+    writeUint16(transport_header + 2, blueprint.dst_port);
+    transport_header[12] = 0x50;
+    transport_header[13] = 0x18;
+    writeUint16(transport_header + 14, 0xffff);
+  } else if (transport == PacketBlueprint::Transport::UDP) {
+    writeUint16(transport_header, blueprint.src_port);
+    writeUint16(transport_header + 2, blueprint.dst_port);
+  } else {
+    transport_header[0] = 8;
+  }
+
+  byte* payload = transport_header + transport_header_size;
+  ::std::copy(blueprint.payload.begin(), blueprint.payload.end(), payload);
+  ::std::fill(payload + blueprint.payload.size(), frame.data() + frame.size(), filler);
+
+  for (const auto& [offset, bytes] : blueprint.raw_bytes) {
+    ::std::copy(bytes.begin(), bytes.end(), frame.begin() + offset);
+  }
+
+  // Длины и контрольная сумма пишутся последними, чтобы учесть итоговый размер и байты поверх заголовков
+  writeUint16(ip + 2, static_cast<uint16_t>(frame.size() - kEthernetHeaderSize));
+  if (transport == PacketBlueprint::Transport::UDP) {
+    writeUint16(transport_header + 4, static_cast<uint16_t>(kUdpHeaderSize + payload_size));
+  }
+  writeUint16(ip + 10, 0);
+  writeUint16(ip + 10, checksum(ip, kIpHeaderSize));
+  return frame;
+}
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ObjectPool.h"
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "packet_buffer_pool.h"
+#include "packet_memory.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+struct PoolRegistry {
+  ::std::mutex mutex;
+  PacketBufferPool::Config config;
+  ::std::vector<const PacketBufferPool*> pools;
+  PacketBufferPool::Statistics retired; ///< Счетчики уже уничтоженных пулов
+};
+
+PoolRegistry& getRegistry() noexcept {
+  static PoolRegistry registry;
+  return registry;
+}
+
+void addStatistics(PacketBufferPool::Statistics& total, const PacketBufferPool::Statistics& statistics) noexcept {
+  total.buffers += statistics.buffers;
+  total.buffers_in_use += statistics.buffers_in_use;
+  total.exhausted += statistics.exhausted;
+  total.oversized += statistics.oversized;
+}
+
+
+}  // namespace
+
+
+PacketBufferPool::PacketBufferPool(const Config& config) noexcept
+  : buffer_size_{(::std::max<size_t>(config.buffer_size, 1) + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize}
+  , buffer_count_{config.buffer_count}
+  , raw_packets_{config.shell_count}
+{
+  if (!memory_.allocate(buffer_size_ * buffer_count_, config.memory)) {
+    ::std::cerr << "Couldn't allocate packet buffer pool of " << buffer_count_ << " buffers" << ::std::endl;
+    buffer_count_ = 0;
+  }
+  free_slots_.reserve(buffer_count_);
+  for (size_t i = 0; i < buffer_count_; ++i) {
+    // Оболочка сразу делается не владеющей данными, дальше в нее только подставляется кадр
+    auto* raw_packet = new ::pcpp::RawPacket();
+    raw_packet->initWithRawData(memory_.data() + i * buffer_size_, 0, timespec{}, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET);
+    free_slots_.push_back(Slot{.buffer = memory_.data() + i * buffer_size_, .raw_packet = raw_packet});
+  }
+
+  auto& registry = getRegistry();
+  ::std::lock_guard lock{registry.mutex};
+  registry.pools.push_back(this);
+}
+
+PacketBufferPool::~PacketBufferPool() noexcept {
+  {
+    auto& registry = getRegistry();
+    ::std::lock_guard lock{registry.mutex};
+    addStatistics(registry.retired, Statistics{
+      .exhausted = exhausted_.load(::std::memory_order_relaxed),
+      .oversized = oversized_.load(::std::memory_order_relaxed),
+    });
+    registry.pools.erase(::std::find(registry.pools.begin(), registry.pools.end(), this));
+  }
+  // Пакеты держат свой пул, поэтому к этому моменту все слоты возвращены
+  for (const auto& slot : free_slots_) {
+    delete slot.raw_packet;
+  }
+}
+
+bool PacketBufferPool::acquireSlot(size_t length, Slot& slot) noexcept {
+  if (length > buffer_size_) {
+    oversized_.fetch_add(1, ::std::memory_order_relaxed);
+    return false;
+  }
+  ::std::unique_lock lock{slots_mutex_};
+  if (free_slots_.empty()) {
+    lock.unlock();
+    exhausted_.fetch_add(1, ::std::memory_order_relaxed);
+    return false;
+  }
+  slot = free_slots_.back();
+  free_slots_.pop_back();
+  return true;
+}
+
+void PacketBufferPool::releaseSlot(const Slot& slot) noexcept {
+  ::std::lock_guard lock{slots_mutex_};
+  free_slots_.push_back(slot);
+}
+
+void PacketBufferPool::releaseBuffer(byte* buffer) noexcept {
+  auto raw_packet = raw_packets_.acquireObject();
+  raw_packet->initWithRawData(buffer, 0, timespec{}, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET);
+  releaseSlot(Slot{.buffer = buffer, .raw_packet = raw_packet.release()});
+}
+
+::std::unique_ptr<::pcpp::RawPacket> PacketBufferPool::acquireRawPacket() noexcept {
+  return raw_packets_.acquireObject();
+}
+
+void PacketBufferPool::releaseRawPacket(::std::unique_ptr<::pcpp::RawPacket> raw_packet) noexcept {
+  raw_packet->clear();
+  raw_packets_.releaseObject(::std::move(raw_packet));
+}
+
+
+PacketBufferPool::Statistics PacketBufferPool::getStatistics() const noexcept {
+  size_t free_count = 0;
+  {
+    ::std::lock_guard lock{slots_mutex_};
+    free_count = free_slots_.size();
+  }
+  return Statistics{
+    .buffers = buffer_count_,
+    .buffers_in_use = buffer_count_ - free_count,
+    .exhausted = exhausted_.load(::std::memory_order_relaxed),
+    .oversized = oversized_.load(::std::memory_order_relaxed),
+  };
+}
+
+const ::std::shared_ptr<PacketBufferPool>& PacketBufferPool::getThreadPool() noexcept {
+  thread_local const ::std::shared_ptr<PacketBufferPool> pool = []() -> ::std::shared_ptr<PacketBufferPool> {
+    Config config;
+    {
+      auto& registry = getRegistry();
+      ::std::lock_guard lock{registry.mutex};
+      config = registry.config;
+    }
+    if (!config.buffer_count) {
+      return nullptr;
+    }
+    return ::std::make_shared<PacketBufferPool>(config);
+  }();
+  return pool;
+}
+
+void PacketBufferPool::setThreadPoolConfig(const Config& config) noexcept {
+  auto& registry = getRegistry();
+  ::std::lock_guard lock{registry.mutex};
+  registry.config = config;
+}
+
+PacketBufferPool::Statistics PacketBufferPool::getTotalStatistics() noexcept {
+  auto& registry = getRegistry();
+  ::std::lock_guard lock{registry.mutex};
+  Statistics total = registry.retired;
+  for (const auto* pool : registry.pools) {
+    addStatistics(total, pool->getStatistics());
+  }
+  return total;
+}
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+#include "RawPacket.h"
+
+#include "decapsulation.h"
+#include "internal_structs.h"
+#include "packet_deduplicator.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr uint64_t kMultiplier{0x9e3779b97f4a7c15ull};
+
+uint64_t mix(uint64_t hash, const byte* data, size_t length) noexcept {
+  while (length >= sizeof(uint64_t)) {
+    uint64_t word;
+    ::std::memcpy(&word, data, sizeof(word));
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 32;
+    data += sizeof(word);
+    length -= sizeof(word);
+  }
+  if (length) {
+    uint64_t word = 0;
+    ::std::memcpy(&word, data, length);
+    hash = (hash ^ word ^ (static_cast<uint64_t>(length) << 56)) * kMultiplier;
+    hash ^= hash >> 32;
+  }
+  return hash;
+}
+
+}  // namespace
+
+
+PacketDeduplicator::PacketDeduplicator(const Config& config) noexcept
+  : config_{config}
+{
+  config_.window_ms = ::std::min<uint32_t>(config_.window_ms, kTickMask / 2);
+  const size_t table_size = ::std::bit_ceil(::std::max(config_.table_size, kBucketSize));
+  mask_ = table_size - 1;
+  slots_ = ::std::make_unique<::std::atomic<uint64_t>[]>(table_size);
+}
+
+bool PacketDeduplicator::isDuplicate(const Packet& packet) noexcept {
+  const auto& raw_packet = *packet.packet;
+  const uint64_t hash = computeHash(raw_packet.getRawData(), static_cast<size_t>(raw_packet.getRawDataLen()),
+      raw_packet.getLinkLayerType(), config_.prefix_length);
+  const auto& timestamp = raw_packet.getPacketTimeStamp();
+  const uint64_t tick = (static_cast<uint64_t>(timestamp.tv_sec) * 1000
+      + static_cast<uint64_t>(timestamp.tv_nsec) / 1000000) & kTickMask;
+  // Нулевая ячейка считается пустой, поэтому младший бит отпечатка всегда установлен
+  const uint64_t fingerprint = (hash >> kTickBits) | 1;
+  const uint64_t entry = (fingerprint << kTickBits) | tick;
+
+  const size_t bucket = hash & mask_ & ~(kBucketSize - 1);
+  size_t victim = bucket;
+  uint64_t victim_value = 0;
+  uint64_t victim_age = 0;
+  for (size_t i = bucket; i < bucket + kBucketSize; ++i) {
+    const uint64_t value = slots_[i].load(::std::memory_order_relaxed);
+    // Пакеты из разных потоков приходят не строго по порядку, поэтому возраст берется по модулю
+    uint64_t age = (tick - value) & kTickMask;
+    age = ::std::min(age, (kTickMask + 1) - age);
+    if (value && (value >> kTickBits) == fingerprint && age <= config_.window_ms) {
+      duplicates_count_.fetch_add(1, ::std::memory_order_relaxed);
+      return true;
+    }
+    const uint64_t victim_priority = value ? age : kTickMask + 1;
+    if (i == bucket || victim_priority > victim_age) {
+      victim = i;
+      victim_value = value;
+      victim_age = victim_priority;
+    }
+  }
+  slots_[victim].compare_exchange_strong(victim_value, entry, ::std::memory_order_relaxed);
+  return false;
+}
+
+size_t PacketDeduplicator::removeDuplicates(::std::span<Packet> packets) noexcept {
+  size_t kept = 0;
+  for (auto& packet : packets) {
+    if (isDuplicate(packet)) {
+      continue;
+    }
+    if (&packet != &packets[kept]) {
+      packets[kept] = ::std::move(packet);
+    }
+    ++kept;
+  }
+  return kept;
+}
+
+uint64_t PacketDeduplicator::getDuplicatesCount() const noexcept {
+  return duplicates_count_.load(::std::memory_order_relaxed);
+}
+
+uint64_t PacketDeduplicator::computeHash(const byte* data, size_t length,
+    ::pcpp::LinkLayerType link_type, size_t prefix_length) noexcept {
+  size_t offset = 0;
+  uint16_t ether_type = 0;
+  if (link_type == ::pcpp::LinkLayerType::LINKTYPE_ETHERNET && length >= 14) {
+    ether_type = readBigEndian16(data + 12);
+    offset = 14;
+    while ((ether_type == 0x8100 || ether_type == 0x88a8) && length >= offset + 4) {
+      ether_type = readBigEndian16(data + offset + 2);
+      offset += 4;
+    }
+  } else if ((link_type == ::pcpp::LinkLayerType::LINKTYPE_RAW
+      || link_type == ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1
+      || link_type == ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW2) && length > 0) {
+    ether_type = (data[0] >> 4) == 6 ? 0x86dd : 0x0800;
+  }
+
+  const byte* ip = data + offset;
+  const size_t ip_length = length - offset;
+  uint64_t hash = kMultiplier;
+  size_t l4_offset = 0;
+  if (ether_type == 0x0800 && ip_length >= 20 && (ip[0] >> 4) == 4) {
+    // Длина, идентификатор, смещение фрагмента, протокол и адреса; без TTL и контрольной суммы
+    hash = mix(hash, ip + 2, 6);
+    hash = mix(hash, ip + 9, 1);
+    hash = mix(hash, ip + 12, 8);
+    l4_offset = static_cast<size_t>(ip[0] & 0x0f) * 4;
+  } else if (ether_type == 0x86dd && ip_length >= 40 && (ip[0] >> 4) == 6) {
+    // Все поля, кроме Hop Limit
+    hash = mix(hash, ip, 7);
+    hash = mix(hash, ip + 8, 32);
+    l4_offset = 40;
+  } else {
+    return mix(hash, data, length);
+  }
+
+  if (l4_offset < ip_length) {
+    hash = mix(hash, ip + l4_offset, ::std::min(ip_length - l4_offset, prefix_length));
+  }
+  return hash;
+}
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+#include <linux/mman.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "internal_structs.h"
+#include "packet_memory.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+size_t roundUp(size_t size, size_t alignment) noexcept {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Пулы создаются в каждом потоке, поэтому о недоступности huge pages и mlock сообщается один раз
+void warnOnce(::std::atomic<bool>& warned, const char* message) noexcept {
+  if (!warned.exchange(true, ::std::memory_order_relaxed)) {
+    ::std::cerr << message << ::std::strerror(errno) << ::std::endl;
+  }
+}
+
+::std::atomic<bool> huge_pages_warned{false};
+::std::atomic<bool> lock_warned{false};
+::std::atomic<bool> page_size_warned{false};
+
+
+}  // namespace
+
+
+PacketMemory::PacketMemory() noexcept {}
+
+PacketMemory::~PacketMemory() noexcept {
+  release();
+}
+
+bool PacketMemory::allocate(size_t size, const Config& config) noexcept {
+  release();
+  if (!size) {
+    return true;
+  }
+
+  // Пул одного потока занимает единицы мегабайт, и округление до 1G расходовало бы по странице
+  // из небольшого резерва на каждый поток, поэтому такие пулы размещаются на 2M страницах
+  size_t huge_page_size = config.huge_page_size;
+  if (huge_page_size == kHugePageSize1G && size < kHugePageSize1G / 2) {
+    if (!page_size_warned.exchange(true, ::std::memory_order_relaxed)) {
+      ::std::cerr << "Packet memory of " << size << " bytes is much smaller than a 1G page, using 2M pages"
+          << ::std::endl;
+    }
+    huge_page_size = kHugePageSize2M;
+  }
+
+  const int populate = config.lock ? MAP_POPULATE : 0;
+  void* area = MAP_FAILED;
+  if (huge_page_size) {
+    const int page_flag = huge_page_size == kHugePageSize1G ? MAP_HUGE_1GB : MAP_HUGE_2MB;
+    size_ = roundUp(size, huge_page_size);
+    area = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_flag | populate, -1, 0);
+    if (area == MAP_FAILED) {
+      warnOnce(huge_pages_warned, "Couldn't allocate huge pages for packets, using regular pages: ");
+    }
+  }
+  huge_ = area != MAP_FAILED;
+  if (!huge_) {
+    size_ = roundUp(size, static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+    area = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | populate, -1, 0);
+    if (area == MAP_FAILED) {
+      ::std::cerr << "Couldn't map " << size_ << " bytes of packet memory: " << ::std::strerror(errno) << ::std::endl;
+      size_ = 0;
+      return false;
+    }
+    if (huge_page_size) {
+      ::madvise(area, size_, MADV_HUGEPAGE);
+    }
+  }
+  data_ = static_cast<byte*>(area);
+
+  if (config.lock) {
+    locked_ = ::mlock(data_, size_) == 0;
+    if (!locked_) {
+      warnOnce(lock_warned, "Couldn't lock packet memory, check RLIMIT_MEMLOCK: ");
+    }
+  }
+  return true;
+}
+
+void PacketMemory::release() noexcept {
+  if (data_) {
+    ::munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  huge_ = false;
+  locked_ = false;
+}
+
+byte* PacketMemory::data() const noexcept {
+  return data_;
+}
+
+size_t PacketMemory::size() const noexcept {
+  return size_;
+}
+
+bool PacketMemory::isHuge() const noexcept {
+  return huge_;
+}
+
+bool PacketMemory::isLocked() const noexcept {
+  return locked_;
+}
+
+
+}  // namespace flow_inspector::internal
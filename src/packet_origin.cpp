@@ -1,10 +1,17 @@
 #include <functional>
 #include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 #include <pcap.h>
 
 #include "internal_structs.h"
 #include "debug_logger.h"
+#include "packet_blueprint.h"
 #include "packet_origin.h"
 
 
@@ -19,6 +26,31 @@ void PacketOrigin::processPacket(const ::pcpp::RawPacket& packet) noexcept {
   packet_processor_(internal::Packet{packet});
 }
 
+void PacketOrigin::processPacket(internal::Packet packet) noexcept {
+  packet_processor_(::std::move(packet));
+}
+
+void PacketOrigin::setBatchProcessor(BatchProcessor processor) noexcept {
+  batch_processor_ = ::std::move(processor);
+}
+
+void PacketOrigin::processPackets(::std::span<internal::Packet> packets) noexcept {
+  if (batch_processor_) {
+    batch_processor_(packets);
+    return;
+  }
+  for (auto& packet : packets) {
+    packet_processor_(::std::move(packet));
+  }
+}
+
+void PacketOrigin::flushBatch(::std::vector<internal::Packet>& batch) noexcept {
+  if (!batch.empty()) {
+    processPackets(batch);
+    batch.clear();
+  }
+}
+
 void PacketOrigin::stopReading() noexcept {
   internal::coutDebug() << "Stopping reading" << std::endl;
   done_.store(true);
@@ -29,5 +61,59 @@ bool PacketOrigin::isDoneReading() const noexcept {
   return done_.load();
 }
 
+bool PacketOrigin::hasFailed() const noexcept {
+  return failed_.load();
+}
+
+void PacketOrigin::markFailed() noexcept {
+  failed_.store(true);
+}
+
+bool PacketOrigin::hasOwnWorkers() const noexcept {
+  return false;
+}
+
+::std::string PacketOrigin::getStatistics() noexcept {
+  return {};
+}
+
+bool PacketOrigin::getCaptureStatistics(CaptureStatistics& statistics) noexcept {
+  ::std::lock_guard<::std::mutex> lock(capture_statistics_mutex_);
+  if (!capture_statistics_) {
+    return false;
+  }
+  statistics = *capture_statistics_;
+  return true;
+}
+
+void PacketOrigin::setCaptureStatistics(const CaptureStatistics& statistics) noexcept {
+  ::std::lock_guard<::std::mutex> lock(capture_statistics_mutex_);
+  capture_statistics_ = statistics;
+}
+
+void PacketOrigin::setCaptureFilter(const ::std::string& filter) noexcept {
+  ::std::lock_guard<::std::mutex> lock(capture_filter_mutex_);
+  capture_filter_ = filter;
+  capture_filter_changed_.store(true);
+}
+
+void PacketOrigin::setRuleBlueprints(::std::vector<internal::PacketBlueprint> /* blueprints */) noexcept {}
+
+void PacketOrigin::setSnapshotLength(uint32_t snapshot_length) noexcept {
+  ::std::lock_guard<::std::mutex> lock(capture_filter_mutex_);
+  snapshot_length_ = snapshot_length;
+  capture_filter_changed_.store(true);
+}
+
+bool PacketOrigin::takeCaptureFilter(::std::string& filter, uint32_t& snapshot_length) noexcept {
+  if (!capture_filter_changed_.exchange(false)) {
+    return false;
+  }
+  ::std::lock_guard<::std::mutex> lock(capture_filter_mutex_);
+  filter = capture_filter_;
+  snapshot_length = snapshot_length_;
+  return true;
+}
+
 
 }  // namespace flow_inspector
@@ -1,5 +1,13 @@
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "analyzer.h"
 #include "concurrentqueue.h"
@@ -10,9 +18,22 @@
 namespace flow_inspector {
 
 
+namespace {
+
+
+::std::atomic<uint64_t> next_pool_id{0};
+
+// Токены производителей принадлежат пулу, поток лишь запоминает свой токен для каждого пула
+thread_local ::std::vector<::std::pair<uint64_t, ::moodycamel::ProducerToken*>> thread_producer_tokens;
+
+
+}  // namespace
+
+
 PacketProcessorsPool::PacketProcessorsPool(
     Analyzer& analyzer, const uint8_t num_packet_processors) noexcept
-  : analyzer_{analyzer}
+  : id_{next_pool_id.fetch_add(1)}
+  , analyzer_{analyzer}
 {
   addCallback([this](const internal::Packet& packet) {
     analyzer_.detectThreats(packet);
@@ -28,18 +49,55 @@ void PacketProcessorsPool::addCallback(Callback callback) noexcept {
   callbacks_.push_back(callback);
 }
 
+void PacketProcessorsPool::setMaxQueueDepth(size_t max_queue_depth) noexcept {
+  max_queue_depth_.store(max_queue_depth);
+}
+
 void PacketProcessorsPool::addPacket(internal::Packet packet) noexcept {
-  packets_.enqueue(::std::move(packet));
+  if (acceptedCount(1)) {
+    packets_.enqueue(getProducerToken(), ::std::move(packet));
+  }
 }
 
-bool PacketProcessorsPool::getPacket(internal::Packet& result) noexcept {
-  while (!packets_.try_dequeue(result)) {
-    if (done_.load()) {
-      return false;
+void PacketProcessorsPool::addPackets(::std::span<internal::Packet> packets) noexcept {
+  const size_t count = acceptedCount(packets.size());
+  if (count) {
+    packets_.enqueue_bulk(getProducerToken(), ::std::make_move_iterator(packets.begin()), count);
+  }
+}
+
+size_t PacketProcessorsPool::acceptedCount(size_t count) noexcept {
+  const size_t max_queue_depth = max_queue_depth_.load(::std::memory_order_relaxed);
+  if (!max_queue_depth) {
+    return count;
+  }
+  const size_t queue_depth = packets_.size_approx();
+  const size_t accepted = queue_depth < max_queue_depth ? ::std::min(count, max_queue_depth - queue_depth) : 0;
+  if (accepted < count) {
+    // Обработчики не успевают, лишние пакеты отбрасываются, чтобы не копить память и буферы источника
+    dropped_count_.fetch_add(count - accepted, ::std::memory_order_relaxed);
+  }
+  return accepted;
+}
+
+::moodycamel::ProducerToken& PacketProcessorsPool::getProducerToken() noexcept {
+  for (const auto& [pool_id, token] : thread_producer_tokens) {
+    if (pool_id == id_) {
+      return *token;
     }
-    ::std::this_thread::sleep_for(kSleepTime);
   }
-  return true;
+  ::std::lock_guard<::std::mutex> lock(producer_tokens_mutex_);
+  auto& token = producer_tokens_.emplace_back(::std::make_unique<::moodycamel::ProducerToken>(packets_));
+  thread_producer_tokens.emplace_back(id_, token.get());
+  return *token;
+}
+
+size_t PacketProcessorsPool::getQueueDepth() const noexcept {
+  return packets_.size_approx();
+}
+
+uint64_t PacketProcessorsPool::getDroppedCount() const noexcept {
+  return dropped_count_.load(::std::memory_order_relaxed);
 }
 
 PacketProcessorsPool::~PacketProcessorsPool() noexcept {
@@ -58,13 +116,40 @@ void PacketProcessorsPool::finish() noexcept {
   }
 }
 
+void PacketProcessorsPool::analyzePacket(internal::Packet& packet) noexcept {
+  // Пакет разбирается лениво: только то, что запросят сигнатуры правил
+  for (const auto& callback : callbacks_) {
+    callback(packet);
+  }
+}
+
+void PacketProcessorsPool::analyzePackets(::std::span<internal::Packet> packets) noexcept {
+  for (auto& packet : packets) {
+    analyzePacket(packet);
+  }
+}
+
+size_t PacketProcessorsPool::getPackets(
+    ::moodycamel::ConsumerToken& token, ::std::span<internal::Packet> batch) noexcept {
+  size_t count = 0;
+  while (!(count = packets_.try_dequeue_bulk(token, batch.begin(), batch.size()))) {
+    if (done_.load()) {
+      return 0;
+    }
+    ::std::this_thread::sleep_for(kSleepTime);
+  }
+  return count;
+}
+
 void PacketProcessorsPool::processPacket() noexcept {
   internal::coutDebug() << "thread started" << std::endl;
-  internal::Packet packet{};
-  while (getPacket(packet)) {
-    packet.parse();
-    for (const auto& callback : callbacks_) {
-      callback(packet);
+  ::moodycamel::ConsumerToken token{packets_};
+  ::std::vector<internal::Packet> batch(kMaxBatchSize);
+  while (const size_t count = getPackets(token, batch)) {
+    for (size_t i = 0; i < count; ++i) {
+      analyzePacket(batch[i]);
+      // Пакет может ссылаться на буфер источника, отпускаем его сразу после анализа
+      batch[i] = internal::Packet{};
     }
   }
   internal::coutDebug() << "thread ended" << std::endl;
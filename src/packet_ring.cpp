@@ -0,0 +1,294 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <pcap.h>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "packet_ring.h"
+
+
+namespace flow_inspector::internal {
+
+
+struct PacketRing::Mapping {
+  int fd{-1};
+  uint8_t* area{nullptr};
+  size_t area_size{0};
+  uint32_t block_size{0};
+  uint32_t block_count{0};
+  ::std::unique_ptr<::std::atomic<bool>[]> in_flight;
+  ::std::mutex release_mutex;
+  ::std::condition_variable released;
+  ::std::atomic<uint64_t> stalls{0};
+
+  tpacket_block_desc* block(uint32_t index) const noexcept {
+    return reinterpret_cast<tpacket_block_desc*>(area + static_cast<size_t>(index) * block_size);
+  }
+
+  void release(uint32_t index) noexcept {
+    __atomic_store_n(&block(index)->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    {
+      ::std::lock_guard<::std::mutex> lock(release_mutex);
+      in_flight[index].store(false, ::std::memory_order_release);
+    }
+    released.notify_all();
+  }
+
+  ~Mapping() noexcept {
+    if (area) {
+      ::munmap(area, area_size);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+
+PacketRing::PacketRing() noexcept {}
+
+PacketRing::~PacketRing() noexcept {
+  close();
+}
+
+bool PacketRing::open(const ::std::string& interface_name, const Config& config) noexcept {
+  close();
+
+  auto mapping = ::std::make_shared<Mapping>();
+  mapping->fd = ::socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+  if (mapping->fd < 0) {
+    ::std::cerr << "Couldn't create packet socket: " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+
+  int version = TPACKET_V3;
+  if (::setsockopt(mapping->fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+    ::std::cerr << "TPACKET_V3 is not supported: " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+
+  tpacket_req3 req{};
+  req.tp_block_size = config.block_size;
+  req.tp_block_nr = config.block_count;
+  req.tp_frame_size = config.frame_size;
+  req.tp_frame_nr = static_cast<unsigned int>(
+      static_cast<uint64_t>(config.block_size) * config.block_count / config.frame_size);
+  req.tp_retire_blk_tov = config.retire_timeout_ms;
+  if (::setsockopt(mapping->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+    ::std::cerr << "Couldn't create packet ring: " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+
+  mapping->block_size = config.block_size;
+  mapping->block_count = config.block_count;
+  mapping->area_size = static_cast<size_t>(config.block_size) * config.block_count;
+  void* area = ::mmap(nullptr, mapping->area_size, PROT_READ | PROT_WRITE, MAP_SHARED, mapping->fd, 0);
+  if (area == MAP_FAILED) {
+    ::std::cerr << "Couldn't map packet ring: " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  mapping->area = static_cast<uint8_t*>(area);
+  mapping->in_flight = ::std::make_unique<::std::atomic<bool>[]>(config.block_count);
+
+  sockaddr_ll address{};
+  address.sll_family = AF_PACKET;
+  address.sll_protocol = htons(ETH_P_ALL);
+  address.sll_ifindex = static_cast<int>(::if_nametoindex(interface_name.c_str()));
+  if (address.sll_ifindex == 0) {
+    ::std::cerr << "Couldn't find device " << interface_name << ::std::endl;
+    return false;
+  }
+  if (::bind(mapping->fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    ::std::cerr << "Couldn't bind packet socket to " << interface_name << ": "
+        << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+
+  link_type_ = queryLinkLayerType(interface_name);
+  current_block_ = 0;
+  statistics_ = Statistics{};
+  mapping_ = ::std::move(mapping);
+  return true;
+}
+
+bool PacketRing::joinFanout(uint16_t group_id, uint16_t mode) noexcept {
+  if (!mapping_) {
+    return false;
+  }
+  uint16_t flags = (mode == PACKET_FANOUT_HASH) ? PACKET_FANOUT_FLAG_DEFRAG : 0;
+  int argument = group_id | ((mode | flags) << 16);
+  if (::setsockopt(mapping_->fd, SOL_PACKET, PACKET_FANOUT, &argument, sizeof(argument)) < 0) {
+    ::std::cerr << "Couldn't join fanout group " << group_id << ": "
+        << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool PacketRing::setFilter(const ::std::string& filter, uint32_t snapshot_length) noexcept {
+  if (!mapping_) {
+    return false;
+  }
+  if (filter.empty() && !snapshot_length) {
+    int unused = 0;
+    ::setsockopt(mapping_->fd, SOL_SOCKET, SO_DETACH_FILTER, &unused, sizeof(unused));
+    return true;
+  }
+
+  const int dlt = link_type_ == ::pcpp::LinkLayerType::LINKTYPE_RAW ? DLT_RAW : DLT_EN10MB;
+  pcap_t* dead = ::pcap_open_dead(dlt, snapshot_length ? static_cast<int>(snapshot_length) : kMaxFrameLength);
+  if (!dead) {
+    return false;
+  }
+  bpf_program program{};
+  if (::pcap_compile(dead, &program, filter.c_str(), 1, PCAP_NETMASK_UNKNOWN) < 0) {
+    ::std::cerr << "Couldn't compile capture filter '" << filter << "': " << ::pcap_geterr(dead) << ::std::endl;
+    ::pcap_close(dead);
+    return false;
+  }
+  ::pcap_close(dead);
+
+  sock_fprog kernel_program{
+    .len = static_cast<unsigned short>(program.bf_len),
+    .filter = reinterpret_cast<sock_filter*>(program.bf_insns),
+  };
+  const bool attached = ::setsockopt(mapping_->fd, SOL_SOCKET, SO_ATTACH_FILTER,
+      &kernel_program, sizeof(kernel_program)) == 0;
+  if (!attached) {
+    ::std::cerr << "Couldn't attach capture filter: " << ::std::strerror(errno) << ::std::endl;
+  }
+  ::pcap_freecode(&program);
+  return attached;
+}
+
+void PacketRing::close() noexcept {
+  if (mapping_) {
+    getStatistics();
+  }
+  mapping_.reset();
+}
+
+bool PacketRing::isOpen() const noexcept {
+  return static_cast<bool>(mapping_);
+}
+
+bool PacketRing::readBlock(int timeout_ms, const PacketHandler& handler) noexcept {
+  if (!mapping_) {
+    return false;
+  }
+  const auto& mapping = mapping_;
+  const uint32_t index = current_block_;
+  auto* desc = mapping->block(index);
+
+  if (mapping->in_flight[index].load(::std::memory_order_acquire)) {
+    // Блок с прошлого круга еще не отпущен обработчиками, ядро тоже ждет его
+    mapping->stalls.fetch_add(1, ::std::memory_order_relaxed);
+    ::std::unique_lock<::std::mutex> lock(mapping->release_mutex);
+    if (!mapping->released.wait_for(lock, ::std::chrono::milliseconds(timeout_ms), [&mapping, index]() {
+      return !mapping->in_flight[index].load(::std::memory_order_acquire);
+    })) {
+      return true;
+    }
+  }
+  if (!(__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+    pollfd pfd{.fd = mapping->fd, .events = POLLIN | POLLERR, .revents = 0};
+    if (::poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR) {
+      return false;
+    }
+    return true;
+  }
+
+  mapping->in_flight[index].store(true, ::std::memory_order_relaxed);
+  ::std::shared_ptr<const void> holder(desc, [mapping, index](const void*) {
+    mapping->release(index);
+  });
+
+  readFrames(reinterpret_cast<const byte*>(desc), link_type_, holder, handler);
+  current_block_ = (index + 1) % mapping->block_count;
+  return true;
+}
+
+uint32_t PacketRing::readFrames(const byte* block, ::pcpp::LinkLayerType link_type,
+    const ::std::shared_ptr<const void>& holder, const PacketHandler& handler) noexcept {
+  const auto* desc = reinterpret_cast<const tpacket_block_desc*>(block);
+  const uint32_t packets_count = desc->hdr.bh1.num_pkts;
+  const auto* header = reinterpret_cast<const tpacket3_hdr*>(block + desc->hdr.bh1.offset_to_first_pkt);
+  for (uint32_t i = 0; i < packets_count; ++i) {
+    const auto* frame = reinterpret_cast<const byte*>(header) + header->tp_mac;
+    timespec timestamp{
+      .tv_sec = static_cast<time_t>(header->tp_sec),
+      .tv_nsec = static_cast<long>(header->tp_nsec),
+    };
+    handler(Packet{frame, header->tp_snaplen, timestamp, link_type, holder});
+    header = reinterpret_cast<const tpacket3_hdr*>(
+        reinterpret_cast<const uint8_t*>(header) + header->tp_next_offset);
+  }
+  return packets_count;
+}
+
+PacketRing::Statistics PacketRing::getStatistics() noexcept {
+  if (!mapping_) {
+    return statistics_;
+  }
+  tpacket_stats_v3 kernel_stats{};
+  socklen_t length = sizeof(kernel_stats);
+  if (::getsockopt(mapping_->fd, SOL_PACKET, PACKET_STATISTICS, &kernel_stats, &length) == 0) {
+    statistics_.packets += kernel_stats.tp_packets;
+    statistics_.drops += kernel_stats.tp_drops;
+  }
+  statistics_.stalls = mapping_->stalls.load(::std::memory_order_relaxed);
+  return statistics_;
+}
+
+::pcpp::LinkLayerType PacketRing::getLinkLayerType() const noexcept {
+  return link_type_;
+}
+
+::pcpp::LinkLayerType PacketRing::queryLinkLayerType(const ::std::string& interface_name) noexcept {
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+  ifreq request{};
+  ::std::strncpy(request.ifr_name, interface_name.c_str(), IFNAMSIZ - 1);
+  int result = ::ioctl(fd, SIOCGIFHWADDR, &request);
+  ::close(fd);
+  if (result < 0) {
+    return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+
+  switch (request.ifr_hwaddr.sa_family) {
+    case ARPHRD_NONE:
+    case ARPHRD_PPP:
+    case ARPHRD_TUNNEL:
+    case ARPHRD_TUNNEL6:
+    case ARPHRD_IPGRE:
+      return ::pcpp::LinkLayerType::LINKTYPE_RAW;
+    default:
+      return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+}
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "events_handler.h"
+#include "internal_structs.h"
+#include "parallel_pcap_reader.h"
+#include "pcap_file_format.h"
+
+
+namespace flow_inspector {
+
+
+void ParallelPcapReader::setFilename(const ::std::string& filename) noexcept {
+  input_file_ = filename;
+}
+
+void ParallelPcapReader::setWorkersCount(uint8_t workers_count) noexcept {
+  workers_count_ = workers_count ? workers_count : 1;
+}
+
+void ParallelPcapReader::setChunkSize(size_t packets_count) noexcept {
+  chunk_packets_ = packets_count ? packets_count : kDefaultChunkPackets;
+}
+
+void ParallelPcapReader::startReading() noexcept {
+  auto file = internal::mapPcapFile(input_file_);
+  if (!file) {
+    return;
+  }
+
+  ::std::vector<size_t> offsets;
+  size_t offset = internal::kPcapFileHeaderSize;
+  internal::PcapRecord record;
+  while (size_t record_size = internal::parsePcapRecord(
+      file->data + offset, file->size - offset, file->info, record)) {
+    offsets.push_back(offset);
+    offset += record_size;
+  }
+  if (offset < file->size) {
+    ::std::cerr << "Pcap file " << input_file_ << " is truncated at offset " << offset << ::std::endl;
+  }
+
+  const size_t chunks_count = (offsets.size() + chunk_packets_ - 1) / chunk_packets_;
+  ::std::atomic<size_t> next_chunk{0};
+  // События фрагментов фиксируются строго по порядку фрагментов в файле
+  ::std::vector<::std::optional<DeferredEvents>> chunk_events(chunks_count);
+  size_t next_commit = 0;
+  ::std::mutex commit_mutex;
+
+  ::std::shared_ptr<const void> holder(file, file->data);
+  auto worker = [&]() {
+    for (size_t chunk = next_chunk++; chunk < chunks_count && !isDoneReading(); chunk = next_chunk++) {
+      DeferredEvents events;
+      internal::PcapRecord chunk_record;
+      EventsHandler::deferEvents(&events);
+      const size_t end = ::std::min(offsets.size(), (chunk + 1) * chunk_packets_);
+      for (size_t i = chunk * chunk_packets_; i < end && !isDoneReading(); ++i) {
+        internal::parsePcapRecord(
+            file->data + offsets[i], file->size - offsets[i], file->info, chunk_record);
+        processPacket(internal::Packet{chunk_record.data, chunk_record.captured_length,
+            chunk_record.timestamp, file->info.link_type, holder});
+      }
+      EventsHandler::deferEvents(nullptr);
+
+      ::std::lock_guard<::std::mutex> lock(commit_mutex);
+      chunk_events[chunk] = ::std::move(events);
+      while (next_commit < chunks_count && chunk_events[next_commit]) {
+        chunk_events[next_commit]->commit();
+        chunk_events[next_commit].reset();
+        ++next_commit;
+      }
+    }
+  };
+
+  ::std::vector<::std::thread> workers;
+  for (uint8_t i = 0; i < workers_count_; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+}
+
+void ParallelPcapReader::internalStopReading() noexcept {}
+
+bool ParallelPcapReader::hasOwnWorkers() const noexcept {
+  return true;
+}
+
+::pcpp::LinkLayerType ParallelPcapReader::getLinkLayerType() noexcept {
+  internal::PcapFileInfo info;
+  if (!internal::readPcapFileInfo(input_file_, info)) {
+    ::std::filesystem::path current_path = ::std::filesystem::current_path();
+    ::std::cerr << "Error opening pcap file: " << input_file_ << ::std::endl;
+    ::std::cerr << "Current directory is " << current_path << ::std::endl;
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return info.link_type;
+}
+
+
+}  // namespace flow_inspector
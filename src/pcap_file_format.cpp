@@ -0,0 +1,126 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "pcap_file_format.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr uint32_t kMicrosecondMagic{0xa1b2c3d4};
+constexpr uint32_t kNanosecondMagic{0xa1b23c4d};
+constexpr uint32_t kMaxRecordLength{256 * 1024};
+
+uint32_t readUint32(const byte* data, bool swapped) noexcept {
+  uint32_t value;
+  ::std::memcpy(&value, data, sizeof(value));
+  return swapped ? __builtin_bswap32(value) : value;
+}
+
+
+}  // namespace
+
+
+bool parsePcapFileHeader(const byte* data, size_t size, PcapFileInfo& info) noexcept {
+  if (size < kPcapFileHeaderSize) {
+    return false;
+  }
+  const uint32_t magic = readUint32(data, false);
+  if (magic == kMicrosecondMagic || magic == kNanosecondMagic) {
+    info.swapped = false;
+  } else if (__builtin_bswap32(magic) == kMicrosecondMagic
+      || __builtin_bswap32(magic) == kNanosecondMagic) {
+    info.swapped = true;
+  } else {
+    return false;
+  }
+  info.nanosecond = readUint32(data, info.swapped) == kNanosecondMagic;
+  info.snapshot_length = readUint32(data + 16, info.swapped);
+  // Старшие биты поля типа канального уровня хранят сведения о FCS
+  info.link_type = static_cast<::pcpp::LinkLayerType>(readUint32(data + 20, info.swapped) & 0x0fffffff);
+  return true;
+}
+
+size_t parsePcapRecord(
+    const byte* data, size_t size, const PcapFileInfo& info, PcapRecord& record) noexcept {
+  if (size < kPcapRecordHeaderSize) {
+    return 0;
+  }
+  const uint32_t seconds = readUint32(data, info.swapped);
+  const uint32_t fraction = readUint32(data + 4, info.swapped);
+  record.captured_length = readUint32(data + 8, info.swapped);
+  record.original_length = readUint32(data + 12, info.swapped);
+  if (record.captured_length > kMaxRecordLength
+      || record.captured_length > size - kPcapRecordHeaderSize) {
+    return 0;
+  }
+  record.timestamp.tv_sec = static_cast<time_t>(seconds);
+  record.timestamp.tv_nsec = static_cast<long>(info.nanosecond ? fraction : fraction * 1000ull);
+  record.data = data + kPcapRecordHeaderSize;
+  return kPcapRecordHeaderSize + record.captured_length;
+}
+
+bool readPcapFileInfo(const ::std::string& filename, PcapFileInfo& info) noexcept {
+  byte header[kPcapFileHeaderSize];
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  const bool header_read = ::read(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+  ::close(fd);
+  return header_read && parsePcapFileHeader(header, sizeof(header), info);
+}
+
+MappedPcapFile::~MappedPcapFile() noexcept {
+  if (data) {
+    ::munmap(const_cast<byte*>(data), size);
+  }
+}
+
+::std::shared_ptr<MappedPcapFile> mapPcapFile(const ::std::string& filename) noexcept {
+  auto file = ::std::make_shared<MappedPcapFile>();
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  struct stat file_stat{};
+  if (fd >= 0 && ::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    void* area = ::mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (area != MAP_FAILED) {
+      file->data = static_cast<const byte*>(area);
+      file->size = static_cast<size_t>(file_stat.st_size);
+      ::madvise(area, file->size, MADV_SEQUENTIAL);
+    }
+  }
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  if (!file->data) {
+    ::std::filesystem::path current_path = ::std::filesystem::current_path();
+    ::std::cerr << "Error opening pcap file: " << filename << ::std::endl;
+    ::std::cerr << "Current directory is " << current_path << ::std::endl;
+    return nullptr;
+  }
+  if (!parsePcapFileHeader(file->data, file->size, file->info)) {
+    ::std::cerr << "Unsupported pcap file format: " << filename << ::std::endl;
+    return nullptr;
+  }
+  return file;
+}
+
+
+}  // namespace flow_inspector::internal
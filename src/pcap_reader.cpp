@@ -1,5 +1,6 @@
 #include <filesystem>
 #include <iostream>
+#include <vector>
 
 #include "RawPacket.h"
 #include "PcapFileDevice.h"
@@ -25,9 +26,15 @@ void PcapReader::startReading() noexcept {
   }
 
   ::pcpp::RawPacket raw_packet;
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
   while (reader->getNextPacket(raw_packet) && !isDoneReading()) {
-    processPacket(raw_packet);
+    batch.emplace_back(raw_packet);
+    if (batch.size() == kBatchSize) {
+      flushBatch(batch);
+    }
   }
+  flushBatch(batch);
 
   reader->close();
   delete reader;
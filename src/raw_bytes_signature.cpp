@@ -17,6 +17,7 @@
 
 #include "debug_logger.h"
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 #include "raw_bytes_signature.h"
 
 
@@ -65,6 +66,24 @@ size_t RawBytesSignature::hash() const noexcept {
       (::std::hash<::std::optional<uint32_t>>{}(payload_offset_) << 1);
 }
 
+bool RawBytesSignature::fillBlueprint(PacketBlueprint& blueprint) const noexcept {
+  if (payload_offset_) {
+    blueprint.raw_bytes.emplace_back(
+        *payload_offset_, ::std::vector<byte>(payload_->begin(), payload_->end()));
+  } else {
+    blueprint.payload.insert(blueprint.payload.end(), payload_->begin(), payload_->end());
+  }
+  return true;
+}
+
+size_t RawBytesSignature::getInspectedLength() const noexcept {
+  return payload_offset_ ? *payload_offset_ + payload_->size() : 0;
+}
+
+bool RawBytesSignature::usesHeaders() const noexcept {
+  return false;
+}
+
 ::std::unique_ptr<Signature> RawBytesSignature::createRawBytesSignature(
     const ::std::string& initString) noexcept {
   ::std::istringstream stream(initString);
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "RawPacket.h"
+
+#include "debug_logger.h"
+#include "internal_structs.h"
+#include "pcap_file_format.h"
+#include "replay_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+::std::chrono::nanoseconds timestampDiff(const timespec& later, const timespec& earlier) noexcept {
+  return ::std::chrono::seconds(later.tv_sec - earlier.tv_sec)
+      + ::std::chrono::nanoseconds(later.tv_nsec - earlier.tv_nsec);
+}
+
+
+}  // namespace
+
+
+void ReplayReader::setFilename(const ::std::string& filename) noexcept {
+  input_file_ = filename;
+}
+
+void ReplayReader::setReplayConfig(const Config& config) noexcept {
+  config_ = config;
+}
+
+void ReplayReader::startReading() noexcept {
+  auto file = internal::mapPcapFile(input_file_);
+  if (!file) {
+    return;
+  }
+  ::std::shared_ptr<const void> holder(file, file->data);
+
+  internal::PcapRecord record;
+  if (!internal::parsePcapRecord(file->data + internal::kPcapFileHeaderSize,
+      file->size - internal::kPcapFileHeaderSize, file->info, record)) {
+    return;
+  }
+  const timespec first_timestamp = record.timestamp;
+
+  pacer_.start();
+  started_.store(true);
+  ::std::chrono::nanoseconds loop_offset{0};
+  for (size_t loop = 0; (config_.loops == 0 || loop < config_.loops) && !isDoneReading(); ++loop) {
+    size_t offset = internal::kPcapFileHeaderSize;
+    ::std::chrono::nanoseconds capture_offset{0};
+    while (!isDoneReading()) {
+      const size_t record_size = internal::parsePcapRecord(
+          file->data + offset, file->size - offset, file->info, record);
+      if (!record_size) {
+        break;
+      }
+      offset += record_size;
+
+      const uint64_t packets = replayed_packets_.load(::std::memory_order_relaxed);
+      const uint64_t bytes = replayed_bytes_.load(::std::memory_order_relaxed);
+      if (config_.target_pps) {
+        pacer_.waitUntil(internal::Pacer::offsetAtRate(packets, config_.target_pps));
+      } else if (config_.target_mbps > 0) {
+        pacer_.waitUntil(::std::chrono::nanoseconds(
+            static_cast<int64_t>(static_cast<double>(bytes) * 8'000 / config_.target_mbps)));
+      } else if (config_.speed > 0) {
+        capture_offset = timestampDiff(record.timestamp, first_timestamp);
+        pacer_.waitUntil(loop_offset + ::std::chrono::nanoseconds(
+            static_cast<int64_t>(static_cast<double>(capture_offset.count()) / config_.speed)));
+      }
+
+      processPacket(internal::Packet{
+          record.data, record.captured_length, record.timestamp, file->info.link_type, holder});
+      replayed_packets_.store(packets + 1, ::std::memory_order_relaxed);
+      replayed_bytes_.store(bytes + record.original_length, ::std::memory_order_relaxed);
+    }
+    if (config_.speed > 0) {
+      loop_offset += ::std::chrono::nanoseconds(
+          static_cast<int64_t>(static_cast<double>(capture_offset.count()) / config_.speed));
+    }
+  }
+
+  internal::coutInfo() << "Replay finished: " << describeRate(pacer_.elapsed())
+      << ", target " << describeTarget() << ::std::endl;
+}
+
+void ReplayReader::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType ReplayReader::getLinkLayerType() noexcept {
+  internal::PcapFileInfo info;
+  if (!internal::readPcapFileInfo(input_file_, info)) {
+    ::std::filesystem::path current_path = ::std::filesystem::current_path();
+    ::std::cerr << "Error opening pcap file: " << input_file_ << ::std::endl;
+    ::std::cerr << "Current directory is " << current_path << ::std::endl;
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return info.link_type;
+}
+
+::std::string ReplayReader::getStatistics() noexcept {
+  if (!started_.load()) {
+    return {};
+  }
+  return "Replay: " + describeRate(pacer_.elapsed()) + ", target " + describeTarget();
+}
+
+::std::string ReplayReader::describeRate(::std::chrono::nanoseconds elapsed) const noexcept {
+  const double seconds = ::std::chrono::duration<double>(elapsed).count();
+  const uint64_t packets = replayed_packets_.load(::std::memory_order_relaxed);
+  const uint64_t bytes = replayed_bytes_.load(::std::memory_order_relaxed);
+  ::std::ostringstream result;
+  result << packets << " packets in " << seconds << " s, achieved "
+      << (seconds > 0 ? static_cast<double>(packets) / seconds : 0) << " pps, "
+      << (seconds > 0 ? static_cast<double>(bytes) * 8 / seconds / 1'000'000 : 0) << " Mbps";
+  return result.str();
+}
+
+::std::string ReplayReader::describeTarget() const noexcept {
+  ::std::ostringstream result;
+  if (config_.target_pps) {
+    result << config_.target_pps << " pps";
+  } else if (config_.target_mbps > 0) {
+    result << config_.target_mbps << " Mbps";
+  } else if (config_.speed > 0) {
+    result << config_.speed << "x capture speed";
+  } else {
+    result << "unlimited";
+  }
+  return result.str();
+}
+
+
+}  // namespace flow_inspector
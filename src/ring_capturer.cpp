@@ -0,0 +1,71 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "packet_ring.h"
+#include "ring_capturer.h"
+
+
+namespace flow_inspector {
+
+
+void RingCapturer::setInterfaceName(const ::std::string& interface_name) noexcept {
+  interface_name_ = interface_name;
+}
+
+void RingCapturer::setRingConfig(const internal::PacketRing::Config& config) noexcept {
+  config_ = config;
+}
+
+void RingCapturer::startReading() noexcept {
+  if (!ring_.open(interface_name_, config_)) {
+    ::std::cerr << "Couldn't open device " << interface_name_ << ::std::endl;
+    markFailed();
+    return;
+  }
+
+  // Пакеты блока передаются обработчикам одной пачкой
+  ::std::vector<internal::Packet> batch;
+  auto handler = [&batch](internal::Packet packet) {
+    batch.push_back(::std::move(packet));
+  };
+  ::std::string filter;
+  uint32_t snapshot_length = 0;
+  auto statistics_time = ::std::chrono::steady_clock::now();
+  while (!isDoneReading()) {
+    if (takeCaptureFilter(filter, snapshot_length)) {
+      ring_.setFilter(filter, snapshot_length);
+    }
+    if (!ring_.readBlock(kPollTimeoutMs, handler)) {
+      ::std::cerr << "Error reading packet ring of " << interface_name_ << ::std::endl;
+      break;
+    }
+    flushBatch(batch);
+    if (::std::chrono::steady_clock::now() - statistics_time >= kStatisticsInterval) {
+      updateStatistics();
+      statistics_time = ::std::chrono::steady_clock::now();
+    }
+  }
+
+  ring_.close();
+  updateStatistics();
+}
+
+void RingCapturer::updateStatistics() noexcept {
+  const auto ring_statistics = ring_.getStatistics();
+  setCaptureStatistics(CaptureStatistics{
+    .received = ring_statistics.packets,
+    .kernel_drops = ring_statistics.drops,
+    .stalls = ring_statistics.stalls,
+  });
+}
+
+void RingCapturer::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType RingCapturer::getLinkLayerType() noexcept {
+  return internal::PacketRing::queryLinkLayerType(interface_name_);
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "shm_ring.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr uint64_t kRingMagic{0x464c4f5752494e47}; // "FLOWRING"
+constexpr uint32_t kRingVersion{1};
+constexpr size_t kHeaderSize{4096};
+constexpr size_t kCacheLineSize{64};
+
+::std::string normalizeName(const ::std::string& name) noexcept {
+  return name.starts_with('/') ? name : "/" + name;
+}
+
+size_t alignToCacheLine(size_t size) noexcept {
+  return (size + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+}
+
+
+}  // namespace
+
+
+// Формат общий с внешними писателями, поэтому поля имеют фиксированный размер
+struct ShmRing::Header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t slab_size;
+  uint32_t link_type;
+  alignas(kCacheLineSize) ::std::atomic<uint64_t> head; ///< Количество записанных слотов
+  alignas(kCacheLineSize) ::std::atomic<uint64_t> tail; ///< Количество слотов, возвращенных писателю
+  alignas(kCacheLineSize) ::std::atomic<uint32_t> finished; ///< Писатель закончил работу
+};
+
+struct ShmRing::Descriptor {
+  int64_t seconds;
+  int64_t nanoseconds;
+  uint32_t captured_length;
+  uint32_t original_length;
+};
+
+struct ShmRing::Mapping {
+  static_assert(::std::atomic<uint64_t>::is_always_lock_free);
+  static_assert(sizeof(Header) <= kHeaderSize);
+
+  uint8_t* area{nullptr};
+  size_t size{0};
+  size_t slabs_offset{0};
+  ::std::unique_ptr<::std::atomic<bool>[]> released;
+
+  Header* header() const noexcept {
+    return reinterpret_cast<Header*>(area);
+  }
+
+  uint32_t index(uint64_t position) const noexcept {
+    return static_cast<uint32_t>(position & (header()->slot_count - 1));
+  }
+
+  Descriptor* descriptor(uint64_t position) const noexcept {
+    return reinterpret_cast<Descriptor*>(area + kHeaderSize) + index(position);
+  }
+
+  uint8_t* slab(uint64_t position) const noexcept {
+    return area + slabs_offset + static_cast<size_t>(index(position)) * header()->slab_size;
+  }
+
+  ~Mapping() noexcept {
+    if (area) {
+      ::munmap(area, size);
+    }
+  }
+};
+
+
+ShmRing::ShmRing() noexcept {}
+
+ShmRing::~ShmRing() noexcept {
+  close();
+}
+
+size_t ShmRing::getMappingSize(const Config& config) noexcept {
+  return kHeaderSize + alignToCacheLine(sizeof(Descriptor) * config.slot_count)
+      + static_cast<size_t>(config.slot_count) * config.slab_size;
+}
+
+bool ShmRing::map(int fd, size_t size) noexcept {
+  void* area = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (area == MAP_FAILED) {
+    ::std::cerr << "Couldn't map shared memory ring " << name_ << ": " << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  mapping_ = ::std::make_shared<Mapping>();
+  mapping_->area = static_cast<uint8_t*>(area);
+  mapping_->size = size;
+  return true;
+}
+
+bool ShmRing::create(const ::std::string& name, const Config& config, ::pcpp::LinkLayerType link_type) noexcept {
+  close();
+  if (!config.slot_count || (config.slot_count & (config.slot_count - 1)) || !config.slab_size) {
+    ::std::cerr << "Shared memory ring slot count must be a power of two" << ::std::endl;
+    return false;
+  }
+
+  name_ = normalizeName(name);
+  ::shm_unlink(name_.c_str());
+  int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  const size_t size = getMappingSize(config);
+  if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+    ::std::cerr << "Couldn't create shared memory ring " << name_ << ": " << ::std::strerror(errno) << ::std::endl;
+    if (fd >= 0) {
+      ::close(fd);
+      ::shm_unlink(name_.c_str());
+    }
+    return false;
+  }
+  if (!map(fd, size)) {
+    ::shm_unlink(name_.c_str());
+    return false;
+  }
+
+  auto* header = new (mapping_->area) Header{};
+  header->version = kRingVersion;
+  header->slot_count = config.slot_count;
+  header->slab_size = config.slab_size;
+  header->link_type = static_cast<uint32_t>(link_type);
+  // Читатель проверяет сигнатуру первой, поэтому она записывается последней
+  __atomic_store_n(&header->magic, kRingMagic, __ATOMIC_RELEASE);
+  mapping_->slabs_offset = size - static_cast<size_t>(config.slot_count) * config.slab_size;
+  producer_ = true;
+  position_ = 0;
+  return true;
+}
+
+bool ShmRing::attach(const ::std::string& name) noexcept {
+  close();
+  name_ = normalizeName(name);
+  int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+  struct stat file_stat{};
+  if (fd < 0 || ::fstat(fd, &file_stat) < 0) {
+    ::std::cerr << "Couldn't open shared memory ring " << name_ << ": " << ::std::strerror(errno) << ::std::endl;
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return false;
+  }
+  const auto size = static_cast<size_t>(file_stat.st_size);
+  if (size < kHeaderSize) {
+    ::std::cerr << "Shared memory ring " << name_ << " is not initialized" << ::std::endl;
+    ::close(fd);
+    return false;
+  }
+  if (!map(fd, size)) {
+    return false;
+  }
+
+  const auto* header = mapping_->header();
+  const Config config{.slot_count = header->slot_count, .slab_size = header->slab_size};
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != kRingMagic || header->version != kRingVersion
+      || !config.slot_count || (config.slot_count & (config.slot_count - 1))
+      || getMappingSize(config) != size) {
+    ::std::cerr << "Unsupported shared memory ring format: " << name_ << ::std::endl;
+    mapping_.reset();
+    return false;
+  }
+  mapping_->slabs_offset = size - static_cast<size_t>(config.slot_count) * config.slab_size;
+  mapping_->released = ::std::make_unique<::std::atomic<bool>[]>(config.slot_count);
+  producer_ = false;
+  // Новый читатель продолжает с того места, где остановился предыдущий
+  position_ = mapping_->header()->tail.load(::std::memory_order_acquire);
+  return true;
+}
+
+bool ShmRing::lockMemory() noexcept {
+  if (!mapping_) {
+    return false;
+  }
+  if (::mlock(mapping_->area, mapping_->size) < 0) {
+    ::std::cerr << "Couldn't lock shared memory ring " << name_ << ", check RLIMIT_MEMLOCK: "
+        << ::std::strerror(errno) << ::std::endl;
+    return false;
+  }
+  return true;
+}
+
+void ShmRing::close() noexcept {
+  if (mapping_ && producer_) {
+    ::shm_unlink(name_.c_str());
+  }
+  mapping_.reset();
+  batches_.clear();
+  producer_ = false;
+  position_ = 0;
+}
+
+bool ShmRing::isOpen() const noexcept {
+  return static_cast<bool>(mapping_);
+}
+
+bool ShmRing::push(const byte* data, uint32_t length, uint32_t original_length,
+    const timespec& timestamp) noexcept {
+  if (!mapping_ || !producer_) {
+    return false;
+  }
+  auto* header = mapping_->header();
+  if (position_ - header->tail.load(::std::memory_order_acquire) >= header->slot_count) {
+    return false;
+  }
+  auto* descriptor = mapping_->descriptor(position_);
+  descriptor->seconds = timestamp.tv_sec;
+  descriptor->nanoseconds = timestamp.tv_nsec;
+  descriptor->captured_length = ::std::min(length, header->slab_size);
+  descriptor->original_length = original_length;
+  ::std::memcpy(mapping_->slab(position_), data, descriptor->captured_length);
+  header->head.store(++position_, ::std::memory_order_release);
+  return true;
+}
+
+void ShmRing::finish() noexcept {
+  if (mapping_ && producer_) {
+    mapping_->header()->finished.store(1, ::std::memory_order_release);
+  }
+}
+
+bool ShmRing::isDrained() const noexcept {
+  return !mapping_ || mapping_->header()->tail.load(::std::memory_order_acquire) == position_;
+}
+
+size_t ShmRing::read(size_t max_packets, const PacketHandler& handler) noexcept {
+  if (!mapping_ || producer_) {
+    return 0;
+  }
+  releaseBatches();
+  const auto* header = mapping_->header();
+  const uint64_t head = header->head.load(::std::memory_order_acquire);
+  const auto count = static_cast<size_t>(::std::min<uint64_t>(head - position_, max_packets));
+  if (!count) {
+    return 0;
+  }
+
+  const auto& mapping = mapping_;
+  const uint32_t flag = mapping->index(position_);
+  mapping->released[flag].store(false, ::std::memory_order_relaxed);
+  ::std::shared_ptr<const void> holder(mapping->area, [mapping, flag](const void*) {
+    mapping->released[flag].store(true, ::std::memory_order_release);
+  });
+  const auto link_type = static_cast<::pcpp::LinkLayerType>(header->link_type);
+  for (size_t i = 0; i < count; ++i) {
+    const auto* descriptor = mapping->descriptor(position_ + i);
+    timespec timestamp{
+      .tv_sec = static_cast<time_t>(descriptor->seconds),
+      .tv_nsec = static_cast<long>(descriptor->nanoseconds),
+    };
+    handler(Packet{mapping->slab(position_ + i), ::std::min(descriptor->captured_length, header->slab_size),
+        timestamp, link_type, holder});
+  }
+  batches_.push_back(Batch{.start = position_, .count = count});
+  position_ += count;
+  return count;
+}
+
+bool ShmRing::releaseBatches() noexcept {
+  if (!mapping_ || producer_) {
+    return true;
+  }
+  bool released = false;
+  uint64_t tail = 0;
+  while (!batches_.empty()
+      && mapping_->released[mapping_->index(batches_.front().start)].load(::std::memory_order_acquire)) {
+    tail = batches_.front().start + batches_.front().count;
+    batches_.pop_front();
+    released = true;
+  }
+  if (released) {
+    mapping_->header()->tail.store(tail, ::std::memory_order_release);
+  }
+  return batches_.empty();
+}
+
+bool ShmRing::isFinished() const noexcept {
+  if (!mapping_) {
+    return true;
+  }
+  const auto* header = mapping_->header();
+  return header->finished.load(::std::memory_order_acquire)
+      && header->head.load(::std::memory_order_acquire) == position_;
+}
+
+::pcpp::LinkLayerType ShmRing::getLinkLayerType() const noexcept {
+  if (!mapping_) {
+    return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+  return static_cast<::pcpp::LinkLayerType>(mapping_->header()->link_type);
+}
+
+
+}  // namespace flow_inspector::internal
@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "cxxopts.hpp"
+
+#include "pcap_file_format.h"
+#include "shm_ring.h"
+
+
+namespace {
+
+
+constexpr ::std::chrono::microseconds kFullRingSleep{50};
+constexpr ::std::chrono::milliseconds kDrainSleep{1};
+
+::std::atomic<bool> stopped{false};
+
+
+void signal_handler(int) {
+  stopped = true;
+}
+
+
+}  // namespace
+
+
+int main(int argc, char **argv) {
+  ::cxxopts::Options options("ShmRingProducer",
+      "Reference producer replaying a PCAP file into a FlowInspector shared memory ring");
+
+  options.add_options()
+    ("f,file", "Path to the PCAP file to replay", ::cxxopts::value<::std::string>())
+    ("ring", "Name of the shared memory ring in /dev/shm",
+        ::cxxopts::value<::std::string>()->default_value("flow_inspector"))
+    ("slots", "Number of ring slots, a power of two",
+        ::cxxopts::value<uint32_t>()->default_value("65536"))
+    ("slab-size", "Size of the data slab of a slot in bytes, longer frames are truncated",
+        ::cxxopts::value<uint32_t>()->default_value("2048"))
+    ("loops", "Number of passes over the file",
+        ::cxxopts::value<size_t>()->default_value("1"))
+    ("h,help", "Print usage");
+
+  ::std::string filename;
+  ::std::string ring_name;
+  ::flow_inspector::internal::ShmRing::Config config;
+  size_t loops = 1;
+  try {
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+      ::std::cout << options.help() << ::std::endl;
+      return 0;
+    }
+    if (!result.count("file")) {
+      throw ::cxxopts::exceptions::exception("File is required");
+    }
+    filename = result["file"].as<::std::string>();
+    ring_name = result["ring"].as<::std::string>();
+    config.slot_count = result["slots"].as<uint32_t>();
+    config.slab_size = result["slab-size"].as<uint32_t>();
+    loops = result["loops"].as<size_t>();
+  } catch (const ::cxxopts::exceptions::exception& e) {
+    ::std::cout << options.help() << ::std::endl;
+    ::std::cerr << "Error parsing options: " << e.what() << ::std::endl;
+    return 1;
+  }
+
+  auto file = ::flow_inspector::internal::mapPcapFile(filename);
+  if (!file) {
+    return 1;
+  }
+  ::flow_inspector::internal::ShmRing ring;
+  if (!ring.create(ring_name, config, file->info.link_type)) {
+    return 1;
+  }
+  ::std::signal(SIGINT, signal_handler);
+  ::std::cout << "Replaying " << filename << " into shared memory ring " << ring_name << ::std::endl;
+
+  uint64_t pushed = 0;
+  for (size_t loop = 0; loop < loops && !stopped; ++loop) {
+    size_t offset = ::flow_inspector::internal::kPcapFileHeaderSize;
+    ::flow_inspector::internal::PcapRecord record;
+    while (!stopped) {
+      const size_t record_size = ::flow_inspector::internal::parsePcapRecord(
+          file->data + offset, file->size - offset, file->info, record);
+      if (!record_size) {
+        break;
+      }
+      // Писатель-образец не теряет кадры, а ждет, пока читатель освободит слоты
+      while (!ring.push(record.data, record.captured_length, record.original_length, record.timestamp)) {
+        if (stopped) {
+          break;
+        }
+        ::std::this_thread::sleep_for(kFullRingSleep);
+      }
+      pushed += stopped ? 0 : 1;
+      offset += record_size;
+    }
+  }
+  ring.finish();
+
+  // Кольцо удаляется при закрытии, поэтому писатель ждет, пока читатель заберет все кадры
+  while (!stopped && !ring.isDrained()) {
+    ::std::this_thread::sleep_for(kDrainSleep);
+  }
+  ::std::cout << "Pushed " << pushed << " packets" << ::std::endl;
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shm_ring.h"
+#include "shm_ring_reader.h"
+
+
+namespace flow_inspector {
+
+
+void ShmRingReader::setRingName(const ::std::string& ring_name) noexcept {
+  ring_name_ = ring_name;
+}
+
+void ShmRingReader::setLockMemory(bool lock) noexcept {
+  lock_memory_ = lock;
+}
+
+void ShmRingReader::startReading() noexcept {
+  if (!attach()) {
+    return;
+  }
+
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
+  auto handler = [&batch](internal::Packet packet) {
+    batch.push_back(::std::move(packet));
+  };
+  uint64_t received = 0;
+  uint32_t idle_rounds = 0;
+  auto statistics_time = ::std::chrono::steady_clock::now();
+  while (!isDoneReading()) {
+    const size_t count = ring_.read(kBatchSize, handler);
+    if (count) {
+      flushBatch(batch);
+      received += count;
+      idle_rounds = 0;
+    } else if (ring_.isFinished()) {
+      break;
+    } else if (++idle_rounds < kIdleSpins) {
+      ::std::this_thread::yield();
+    } else {
+      // Писатель отстает, ожидание не должно занимать ядро целиком
+      ::std::this_thread::sleep_for(kIdleSleep);
+    }
+    if (::std::chrono::steady_clock::now() - statistics_time >= kStatisticsInterval) {
+      setCaptureStatistics(CaptureStatistics{.received = received});
+      statistics_time = ::std::chrono::steady_clock::now();
+    }
+  }
+
+  // Писатель ждет возврата всех слотов, прежде чем удалить кольцо
+  while (!isDoneReading() && !ring_.releaseBatches()) {
+    ::std::this_thread::sleep_for(kIdleSleep);
+  }
+  ring_.close();
+  setCaptureStatistics(CaptureStatistics{.received = received});
+}
+
+void ShmRingReader::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType ShmRingReader::getLinkLayerType() noexcept {
+  if (!attach()) {
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return ring_.getLinkLayerType();
+}
+
+bool ShmRingReader::attach() noexcept {
+  if (ring_.isOpen()) {
+    return true;
+  }
+  if (!ring_.attach(ring_name_)) {
+    return false;
+  }
+  if (lock_memory_) {
+    ring_.lockMemory();
+  }
+  return true;
+}
+
+
+}  // namespace flow_inspector
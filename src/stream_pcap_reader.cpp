@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "pcap_file_format.h"
+#include "stream_pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+StreamPcapReader::~StreamPcapReader() noexcept {
+  closeStream();
+}
+
+void StreamPcapReader::setFilename(const ::std::string& filename) noexcept {
+  closeStream();
+  input_file_ = filename;
+}
+
+void StreamPcapReader::setBlockSize(size_t block_size) noexcept {
+  block_size_ = ::std::max(block_size, kMinBlockSize);
+}
+
+bool StreamPcapReader::isStream(const ::std::string& filename) noexcept {
+  if (filename == "-") {
+    return true;
+  }
+  struct stat file_stat{};
+  return ::stat(filename.c_str(), &file_stat) == 0
+      && (S_ISFIFO(file_stat.st_mode) || S_ISCHR(file_stat.st_mode) || S_ISSOCK(file_stat.st_mode));
+}
+
+void StreamPcapReader::startReading() noexcept {
+  if (!openStream()) {
+    return;
+  }
+
+  // Записи разбираются прямо в блоке, пакеты держат блок, пока не будут обработаны
+  auto block = ::std::make_shared<::std::vector<internal::byte>>(block_size_);
+  size_t filled = 0;
+  size_t offset = 0;
+  internal::PcapRecord record;
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
+  while (!isDoneReading()) {
+    const ssize_t bytes_read = readSome(block->data() + filled, block->size() - filled);
+    if (bytes_read < 0) {
+      ::std::cerr << "Couldn't read pcap stream " << input_file_ << ": " << ::std::strerror(errno) << ::std::endl;
+      break;
+    }
+    if (bytes_read == 0) {
+      break;
+    }
+    filled += static_cast<size_t>(bytes_read);
+
+    while (const size_t record_size = internal::parsePcapRecord(
+        block->data() + offset, filled - offset, info_, record)) {
+      batch.emplace_back(record.data, record.captured_length, record.timestamp, info_.link_type, block);
+      if (batch.size() == kBatchSize) {
+        flushBatch(batch);
+      }
+      offset += record_size;
+    }
+    // Следующего чтения из канала можно ждать долго, поэтому прочитанное не задерживается в пачке
+    flushBatch(batch);
+
+    if (filled < block->size()) {
+      continue;
+    }
+    if (offset == 0) {
+      ::std::cerr << "Pcap stream " << input_file_ << " has a corrupted record" << ::std::endl;
+      break;
+    }
+    // Неполная запись в конце заполненного блока переносится в начало следующего
+    auto next_block = block.use_count() > 1 ? ::std::make_shared<::std::vector<internal::byte>>(block_size_) : block;
+    ::std::memmove(next_block->data(), block->data() + offset, filled - offset);
+    block = ::std::move(next_block);
+    filled -= offset;
+    offset = 0;
+  }
+  flushBatch(batch);
+  if (offset < filled && !isDoneReading()) {
+    ::std::cerr << "Pcap stream " << input_file_ << " is truncated" << ::std::endl;
+  }
+  closeStream();
+}
+
+void StreamPcapReader::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType StreamPcapReader::getLinkLayerType() noexcept {
+  if (!openStream()) {
+    return ::pcpp::LinkLayerType::LINKTYPE_DLT_RAW1;
+  }
+  return info_.link_type;
+}
+
+bool StreamPcapReader::openStream() noexcept {
+  if (header_read_) {
+    return true;
+  }
+  if (fd_ < 0) {
+    fd_ = input_file_ == "-" ? STDIN_FILENO : ::open(input_file_.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      ::std::cerr << "Error opening pcap stream " << input_file_ << ": " << ::std::strerror(errno) << ::std::endl;
+      return false;
+    }
+    // Больший буфер канала позволяет писателю, например распаковщику, работать впереди анализа
+    ::fcntl(fd_, F_SETPIPE_SZ, kPipeSize);
+  }
+
+  // Заголовок читается один раз: из канала его нельзя перечитать в startReading
+  internal::byte header[internal::kPcapFileHeaderSize];
+  size_t header_size = 0;
+  while (header_size < sizeof(header)) {
+    const ssize_t bytes_read = readSome(header + header_size, sizeof(header) - header_size);
+    if (bytes_read <= 0) {
+      ::std::cerr << "Couldn't read pcap stream header: " << input_file_ << ::std::endl;
+      closeStream();
+      return false;
+    }
+    header_size += static_cast<size_t>(bytes_read);
+  }
+  if (!internal::parsePcapFileHeader(header, sizeof(header), info_)) {
+    ::std::cerr << "Unsupported pcap stream format: " << input_file_ << ::std::endl;
+    closeStream();
+    return false;
+  }
+  header_read_ = true;
+  return true;
+}
+
+ssize_t StreamPcapReader::readSome(internal::byte* data, size_t size) noexcept {
+  while (!isDoneReading()) {
+    pollfd pfd{.fd = fd_, .events = POLLIN, .revents = 0};
+    const int ready = ::poll(&pfd, 1, kPollTimeoutMs);
+    if (ready < 0 && errno != EINTR) {
+      return -1;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+    const ssize_t bytes_read = ::read(fd_, data, size);
+    if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    return bytes_read;
+  }
+  return 0;
+}
+
+void StreamPcapReader::closeStream() noexcept {
+  if (fd_ > STDIN_FILENO) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+  header_read_ = false;
+}
+
+
+}  // namespace flow_inspector
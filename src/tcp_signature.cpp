@@ -1,11 +1,12 @@
 #include <sstream>
 #include <memory>
 
+#include <netinet/in.h>
 #include <pcap.h>
 #include "Packet.h"
-#include "TcpLayer.h"
 
 #include "internal_structs.h"
+#include "packet_blueprint.h"
 #include "tcp_signature.h"
 
 
@@ -16,17 +17,13 @@ TCPSignature::TCPSignature(uint16_t srcPort, uint16_t dstPort) noexcept
     : src_port_(srcPort), dst_port_(dstPort) {}
 
 bool TCPSignature::check(const Packet& packet) const noexcept {
-  const auto& pcpp_packet = packet.getParsedPacket();
-  const auto tcp_layer = pcpp_packet.getLayerOfType<::pcpp::TcpLayer>();
-  if (!tcp_layer) {
+  const auto& view = packet.getView();
+  if (view.protocol != IPPROTO_TCP || !view.l4_offset) {
     return false;
   }
 
-  uint16_t srcPort = ntohs(tcp_layer->getTcpHeader()->portSrc);
-  uint16_t dstPort = ntohs(tcp_layer->getTcpHeader()->portDst);
-
-  bool src_match = (src_port_ == 0) || (srcPort == src_port_);
-  bool dst_match = (dst_port_ == 0) || (dstPort == dst_port_);
+  bool src_match = (src_port_ == 0) || (view.src_port == src_port_);
+  bool dst_match = (dst_port_ == 0) || (view.dst_port == dst_port_);
 
   return src_match && dst_match;
 }
@@ -46,6 +43,35 @@ size_t TCPSignature::hash() const noexcept {
   return hash_val;
 }
 
+::std::string TCPSignature::getCaptureFilter() const noexcept {
+  ::std::string filter = "tcp";
+  if (src_port_) {
+    filter += " src port " + ::std::to_string(src_port_);
+  }
+  if (dst_port_) {
+    filter += (src_port_ ? " and tcp dst port " : " dst port ") + ::std::to_string(dst_port_);
+  }
+  return filter;
+}
+
+bool TCPSignature::fillBlueprint(PacketBlueprint& blueprint) const noexcept {
+  if (blueprint.transport.value_or(PacketBlueprint::Transport::TCP) != PacketBlueprint::Transport::TCP) {
+    return false;
+  }
+  blueprint.transport = PacketBlueprint::Transport::TCP;
+  if (src_port_) {
+    blueprint.src_port = src_port_;
+  }
+  if (dst_port_) {
+    blueprint.dst_port = dst_port_;
+  }
+  return true;
+}
+
+size_t TCPSignature::getInspectedLength() const noexcept {
+  return kMaxLinkHeaderSize + kMaxTunnelsHeaderSize + kMaxIpHeaderSize + kMaxTcpHeaderSize;
+}
+
 ::std::unique_ptr<Signature> TCPSignature::createTCPSignature(const ::std::string& initString) noexcept {
   ::std::istringstream stream(initString);
   ::std::string srcPortStr, dstPortStr, tmp;
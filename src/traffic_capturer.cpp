@@ -1,11 +1,15 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <thread>
-#include <chrono>
 
 #include <PcapLiveDeviceList.h>
 #include <PcapLiveDevice.h>
 
+#include "debug_logger.h"
 #include "traffic_capturer.h"
 
 
@@ -24,26 +28,137 @@ void TrafficCapturer::setInterfaceName(const ::std::string& interface_name) noex
   interface_name_ = interface_name;
 }
 
+void TrafficCapturer::setCaptureConfig(const Config& config) noexcept {
+  config_ = config;
+}
+
 void TrafficCapturer::startReading() noexcept {
   device_ = ::pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByName(interface_name_);
   if (device_ == nullptr) {
     ::std::cerr << "Couldn't find device " << interface_name_ << ::std::endl;
+    markFailed();
     return;
   }
   
-  if (!device_->open()) {
-    ::std::cerr << "Couldn't open device " << interface_name_ << ::std::endl;
+  takeCaptureFilter(capture_filter_, snapshot_length_);
+  if (!openDevice()) {
+    markFailed();
     return;
   }
-
   device_->startCapture(onPacketArrives, this);
+  last_tune_ = ::std::chrono::steady_clock::now();
 
+  // Остановка приходит и из обработчика сигнала, поэтому флаг завершения замечается по опросу, без пробуждения
   while (!isDoneReading()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ::std::this_thread::sleep_for(kPollInterval);
+    flushPackets();
+    applyCaptureFilter();
+    updateStatistics();
+    autoTuneBuffer();
   }
 
+  updateStatistics();
   device_->stopCapture();
   device_->close();
+  flushPackets();
+}
+
+bool TrafficCapturer::openDevice() noexcept {
+  // Устройство могло быть открыто при запросе типа канального уровня, а длину среза меняет только повторное открытие
+  device_->close();
+  ::pcpp::PcapLiveDevice::DeviceConfiguration config(
+      config_.promiscuous ? ::pcpp::PcapLiveDevice::Promiscuous : ::pcpp::PcapLiveDevice::Normal,
+      config_.buffer_timeout_ms, config_.buffer_size, config_.direction,
+      static_cast<int>(config_.snapshot_length ? config_.snapshot_length : snapshot_length_));
+  if (!device_->open(config)) {
+    ::std::cerr << "Couldn't open device " << interface_name_ << ::std::endl;
+    return false;
+  }
+  if (!capture_filter_.empty() && !device_->setFilter(capture_filter_)) {
+    ::std::cerr << "Couldn't set capture filter on " << interface_name_ << ": " << capture_filter_ << ::std::endl;
+  }
+  return true;
+}
+
+void TrafficCapturer::applyCaptureFilter() noexcept {
+  const uint32_t current_snapshot_length = snapshot_length_;
+  if (!takeCaptureFilter(capture_filter_, snapshot_length_)) {
+    return;
+  }
+  // Длина среза, заданная пользователем, важнее вычисленной по правилам
+  if (snapshot_length_ != current_snapshot_length && !config_.snapshot_length) {
+    reopenDevice();
+    return;
+  }
+  if (capture_filter_.empty()) {
+    device_->clearFilter();
+  } else if (!device_->setFilter(capture_filter_)) {
+    ::std::cerr << "Couldn't set capture filter on " << interface_name_ << ": " << capture_filter_ << ::std::endl;
+  }
+}
+
+void TrafficCapturer::reopenDevice() noexcept {
+  // Счетчики libpcap обнуляются при повторном открытии, сохраняем накопленные
+  updateStatistics();
+  getCaptureStatistics(closed_statistics_);
+  device_->stopCapture();
+  if (openDevice()) {
+    device_->startCapture(onPacketArrives, this);
+  }
+}
+
+void TrafficCapturer::autoTuneBuffer() noexcept {
+  if (!config_.auto_tune) {
+    return;
+  }
+  const auto now = ::std::chrono::steady_clock::now();
+  if (now - last_tune_ < kAutoTuneInterval) {
+    return;
+  }
+  last_tune_ = now;
+
+  CaptureStatistics statistics;
+  if (!getCaptureStatistics(statistics)) {
+    return;
+  }
+  const uint64_t new_drops = statistics.kernel_drops - tuned_kernel_drops_;
+  tuned_kernel_drops_ = statistics.kernel_drops;
+  const int buffer_size = tuneBufferSize(new_drops, config_.buffer_size, config_.max_buffer_size);
+  if (buffer_size == config_.buffer_size) {
+    return;
+  }
+
+  config_.buffer_size = buffer_size;
+  internal::coutInfo() << "Increasing capture buffer of " << interface_name_ << " to "
+      << config_.buffer_size << " bytes after " << new_drops << " drops" << ::std::endl;
+  reopenDevice();
+}
+
+int TrafficCapturer::tuneBufferSize(uint64_t new_drops, int buffer_size, int max_buffer_size) noexcept {
+  if (!new_drops || buffer_size >= max_buffer_size) {
+    return buffer_size;
+  }
+  // Нулевой размер означает буфер libpcap по умолчанию, его точный размер неизвестен
+  const int64_t grown_size = buffer_size ? static_cast<int64_t>(buffer_size) * 2 : kAutoTuneInitialBufferSize;
+  return static_cast<int>(::std::min<int64_t>(grown_size, max_buffer_size));
+}
+
+void TrafficCapturer::updateStatistics() noexcept {
+  if (!device_->isOpened()) {
+    return;
+  }
+  ::pcpp::IPcapDevice::PcapStats stats{};
+  device_->getStatistics(stats);
+  setCaptureStatistics(CaptureStatistics{
+    .received = closed_statistics_.received + stats.packetsRecv,
+    .kernel_drops = closed_statistics_.kernel_drops + stats.packetsDrop,
+    .interface_drops = closed_statistics_.interface_drops + stats.packetsDropByInterface,
+  });
+}
+
+void TrafficCapturer::flushPackets() noexcept {
+  ::std::lock_guard<::std::mutex> lock(batch_mutex_);
+  flushBatch(batch_);
 }
 
 void TrafficCapturer::internalStopReading() noexcept {
@@ -70,7 +185,13 @@ void TrafficCapturer::internalStopReading() noexcept {
 void TrafficCapturer::onPacketArrives(
     ::pcpp::RawPacket* raw_packet, ::pcpp::PcapLiveDevice* /*dev*/, void* user_data) noexcept {
   auto* capturer = reinterpret_cast<TrafficCapturer*>(user_data);
-  capturer->processPacket(*raw_packet);
+  // libpcap отдает кадры по одному, поэтому они копятся в пачку. Неполную пачку отправляет
+  // основной поток по таймеру опроса, чтобы редкие пакеты не ждали дольше kPollInterval
+  ::std::lock_guard<::std::mutex> lock(capturer->batch_mutex_);
+  capturer->batch_.emplace_back(*raw_packet);
+  if (capturer->batch_.size() == kBatchSize) {
+    capturer->flushBatch(capturer->batch_);
+  }
 }
 
 
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "debug_logger.h"
+#include "internal_structs.h"
+#include "packet_blueprint.h"
+#include "traffic_generator.h"
+
+
+namespace flow_inspector {
+
+
+void TrafficGenerator::setGeneratorConfig(const Config& config) noexcept {
+  config_ = config;
+}
+
+void TrafficGenerator::setWorkersCount(uint8_t workers_count) noexcept {
+  workers_count_ = ::std::max<uint8_t>(workers_count, 1);
+}
+
+void TrafficGenerator::setRuleBlueprints(::std::vector<internal::PacketBlueprint> blueprints) noexcept {
+  ::std::lock_guard<::std::mutex> lock(blueprints_mutex_);
+  blueprints_ = ::std::move(blueprints);
+}
+
+void TrafficGenerator::startReading() noexcept {
+  const auto pool = buildPool();
+  if (pool->frames.empty()) {
+    return;
+  }
+  internal::coutInfo() << "Generator pool: " << pool->frames.size() << " frames, "
+      << pool->hits << " of them hit the rules" << ::std::endl;
+  ::std::shared_ptr<const void> holder(pool, pool->data.data());
+
+  claimed_packets_.store(0);
+  start_time_ = ::std::chrono::steady_clock::now();
+  started_.store(true);
+
+  ::std::vector<::std::thread> workers;
+  for (uint8_t i = 1; i < workers_count_; ++i) {
+    workers.emplace_back(&TrafficGenerator::generate, this, ::std::cref(*pool), ::std::cref(holder));
+  }
+  generate(*pool, holder);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  internal::coutInfo() << "Generator finished: " << describeRate() << ::std::endl;
+}
+
+void TrafficGenerator::internalStopReading() noexcept {}
+
+bool TrafficGenerator::hasOwnWorkers() const noexcept {
+  return true;
+}
+
+::pcpp::LinkLayerType TrafficGenerator::getLinkLayerType() noexcept {
+  return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+}
+
+::std::string TrafficGenerator::getStatistics() noexcept {
+  if (!started_.load()) {
+    return {};
+  }
+  return "Generator: " + describeRate();
+}
+
+::std::shared_ptr<const TrafficGenerator::FramePool> TrafficGenerator::buildPool() const noexcept {
+  auto pool = ::std::make_shared<FramePool>();
+  ::std::vector<internal::PacketBlueprint> blueprints;
+  {
+    ::std::lock_guard<::std::mutex> lock(blueprints_mutex_);
+    blueprints = blueprints_;
+  }
+
+  ::std::mt19937_64 random(config_.seed);
+  const size_t min_size = ::std::min(config_.min_size, config_.max_size);
+  ::std::uniform_int_distribution<size_t> size_distribution(min_size, config_.max_size);
+  ::std::uniform_int_distribution<size_t> flow_distribution(0, ::std::max<size_t>(config_.flows, 1) - 1);
+  ::std::uniform_int_distribution<size_t> alphabet_distribution(
+      0, config_.alphabet.empty() ? 255 : config_.alphabet.size() - 1);
+  ::std::discrete_distribution<int> transport_distribution(
+      {double(config_.tcp_weight), double(config_.udp_weight), double(config_.icmp_weight)});
+  ::std::bernoulli_distribution hit_distribution(
+      blueprints.empty() ? 0.0 : ::std::clamp(config_.hit_percent, 0.0, 100.0) / 100);
+  ::std::uniform_int_distribution<size_t> blueprint_distribution(
+      0, ::std::max<size_t>(blueprints.size(), 1) - 1);
+
+  // Поток задается своим номером, чтобы пакеты одного потока имели одинаковые адреса и порты.
+  // Порты берутся вне диапазонов, которые PcapPlusPlus разбирает как прикладные протоколы
+  auto fill_flow = [&](internal::PacketBlueprint& blueprint, size_t flow) {
+    ::std::mt19937_64 flow_random(config_.seed ^ (flow * 0x9e3779b97f4a7c15ull));
+    if (!blueprint.transport) {
+      constexpr internal::PacketBlueprint::Transport kTransports[] = {
+        internal::PacketBlueprint::Transport::TCP,
+        internal::PacketBlueprint::Transport::UDP,
+        internal::PacketBlueprint::Transport::ICMP,
+      };
+      blueprint.transport = kTransports[transport_distribution(flow_random)];
+    }
+    const uint64_t bits = flow_random();
+    if (!blueprint.src_ip) {
+      blueprint.src_ip = 0x0a000000 | static_cast<uint32_t>(bits & 0x00ffffff);
+    }
+    if (!blueprint.dst_ip) {
+      blueprint.dst_ip = 0xac100000 | static_cast<uint32_t>((bits >> 24) & 0x000fffff);
+    }
+    if (!blueprint.src_port) {
+      blueprint.src_port = static_cast<uint16_t>(30000 + (bits >> 44) % 30000);
+    }
+    if (!blueprint.dst_port) {
+      blueprint.dst_port = static_cast<uint16_t>(20000 + flow_random() % 10000);
+    }
+  };
+
+  const size_t pool_size = config_.packets
+      ? ::std::min<uint64_t>(config_.pool_size, config_.packets) : config_.pool_size;
+  for (size_t i = 0; i < pool_size; ++i) {
+    internal::PacketBlueprint blueprint;
+    if (hit_distribution(random)) {
+      blueprint = blueprints[blueprint_distribution(random)];
+      ++pool->hits;
+    }
+    fill_flow(blueprint, flow_distribution(random));
+
+    const size_t frame_size = size_distribution(random);
+    const size_t headers_size = blueprint.headersSize();
+    while (headers_size + blueprint.payload.size() < frame_size) {
+      const size_t symbol = alphabet_distribution(random);
+      blueprint.payload.push_back(config_.alphabet.empty()
+          ? static_cast<internal::byte>(symbol)
+          : static_cast<internal::byte>(config_.alphabet[symbol]));
+    }
+
+    const auto frame = internal::buildFrame(blueprint);
+    pool->frames.emplace_back(pool->data.size(), static_cast<uint32_t>(frame.size()));
+    pool->data.insert(pool->data.end(), frame.begin(), frame.end());
+  }
+  return pool;
+}
+
+void TrafficGenerator::generate(const FramePool& pool, const ::std::shared_ptr<const void>& holder) noexcept {
+  const size_t pool_size = pool.frames.size();
+  ::std::vector<internal::Packet> batch;
+  batch.reserve(kBatchSize);
+  while (!isDoneReading()) {
+    const uint64_t first = claimed_packets_.fetch_add(kBatchSize, ::std::memory_order_relaxed);
+    uint64_t last = first + kBatchSize;
+    if (config_.packets) {
+      last = ::std::min(last, config_.packets);
+      if (first >= last) {
+        break;
+      }
+    }
+
+    timespec timestamp{};
+    ::clock_gettime(CLOCK_REALTIME, &timestamp);
+    uint64_t bytes = 0;
+    for (uint64_t i = first; i < last; ++i) {
+      const auto& [offset, length] = pool.frames[i % pool_size];
+      batch.emplace_back(
+          pool.data.data() + offset, length, timestamp, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, holder);
+      bytes += length;
+    }
+    flushBatch(batch);
+    generated_packets_.fetch_add(last - first, ::std::memory_order_relaxed);
+    generated_bytes_.fetch_add(bytes, ::std::memory_order_relaxed);
+  }
+}
+
+::std::string TrafficGenerator::describeRate() const noexcept {
+  const double seconds = ::std::chrono::duration<double>(
+      ::std::chrono::steady_clock::now() - start_time_).count();
+  const uint64_t packets = generated_packets_.load(::std::memory_order_relaxed);
+  const uint64_t bytes = generated_bytes_.load(::std::memory_order_relaxed);
+  ::std::ostringstream result;
+  result << packets << " packets in " << seconds << " s, "
+      << (seconds > 0 ? static_cast<double>(packets) / seconds : 0) << " pps, "
+      << (seconds > 0 ? static_cast<double>(bytes) * 8 / seconds / 1'000'000 : 0) << " Mbps";
+  return result.str();
+}
+
+
+}  // namespace flow_inspector
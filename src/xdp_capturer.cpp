@@ -0,0 +1,134 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "RawPacket.h"
+#include "XdpDevice.h"
+
+#include "internal_structs.h"
+#include "packet_ring.h"
+#include "xdp_capturer.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+PacketOrigin::CaptureStatistics toCaptureStatistics(const ::pcpp::XdpDevice::XdpDeviceStats& stats) noexcept {
+  return PacketOrigin::CaptureStatistics{
+    .received = stats.rxPackets + stats.rxDroppedTotalPackets,
+    .kernel_drops = stats.rxDroppedRxRingFullPackets + stats.rxDroppedFillRingPackets,
+    .interface_drops = stats.rxDroppedInvalidPackets,
+  };
+}
+
+
+}  // namespace
+
+
+XdpCapturer::XdpCapturer() noexcept {}
+
+XdpCapturer::~XdpCapturer() noexcept {}
+
+void XdpCapturer::setInterfaceName(const ::std::string& interface_name) noexcept {
+  interface_name_ = interface_name;
+}
+
+void XdpCapturer::setXdpConfig(const Config& config) noexcept {
+  config_ = config;
+}
+
+void XdpCapturer::startReading() noexcept {
+  using XdpConfig = ::pcpp::XdpDevice::XdpDeviceConfiguration;
+
+  XdpConfig::AttachMode attach_mode = XdpConfig::AutoMode;
+  if (config_.attach_mode == AttachMode::Skb) {
+    attach_mode = XdpConfig::SkbMode;
+  } else if (config_.attach_mode == AttachMode::Driver) {
+    attach_mode = XdpConfig::DriverMode;
+  }
+  XdpConfig device_config{attach_mode, config_.umem_frames, 0, config_.ring_size,
+      config_.ring_size, config_.ring_size, config_.ring_size, config_.batch_size};
+
+  ::pcpp::XdpDevice device{interface_name_};
+  if (!device.open(device_config)) {
+    ::std::cerr << "Couldn't open device " << interface_name_ << ::std::endl;
+    markFailed();
+    return;
+  }
+
+  while (!isDoneReading()) {
+    if (!device.receivePackets(&XdpCapturer::onPacketsArrive, this, kPollTimeoutMs)) {
+      ::std::cerr << "Error reading XDP socket of " << interface_name_ << ::std::endl;
+      break;
+    }
+    updateStatistics(device, false);
+  }
+
+  updateStatistics(device, true);
+  device.close();
+}
+
+void XdpCapturer::onPacketsArrive(
+    ::pcpp::RawPacket packets[], uint32_t packets_count, ::pcpp::XdpDevice* device, void* cookie) {
+  auto* capturer = static_cast<XdpCapturer*>(cookie);
+  if (capturer->isDoneReading()) {
+    device->stopReceivePackets();
+  }
+
+  capturer->receiveBatch(packets, packets_count);
+  capturer->updateStatistics(*device, false);
+}
+
+void XdpCapturer::receiveBatch(const ::pcpp::RawPacket packets[], uint32_t packets_count) noexcept {
+  // Кадры UMEM возвращаются в fill ring сразу после выхода из колбэка. Ожидание, пока обработчики
+  // отпустят всю пачку, останавливало бы прием на время анализа, поэтому кадры копируются
+  // в буферы пула потока захвата, и колбэк возвращается сразу
+  batch_.reserve(packets_count);
+  for (uint32_t i = 0; i < packets_count; ++i) {
+    batch_.emplace_back(packets[i]);
+  }
+  flushBatch(batch_);
+}
+
+void XdpCapturer::internalStopReading() noexcept {}
+
+::pcpp::LinkLayerType XdpCapturer::getLinkLayerType() noexcept {
+  return internal::PacketRing::queryLinkLayerType(interface_name_);
+}
+
+void XdpCapturer::updateStatistics(::pcpp::XdpDevice& device, bool force) noexcept {
+  // Счетчики устройства меняет прием пакетов, поэтому они читаются только в потоке захвата.
+  // Под нагрузкой receivePackets не возвращается, и счетчики обновляются из колбэка не чаще раза за период опроса
+  const auto now = ::std::chrono::steady_clock::now();
+  if (!force && now - last_statistics_ < ::std::chrono::milliseconds(kPollTimeoutMs)) {
+    return;
+  }
+  last_statistics_ = now;
+
+  const auto stats = device.getStatistics();
+  setCaptureStatistics(toCaptureStatistics(stats));
+  ::std::ostringstream result;
+  result << "XDP: received " << stats.rxPackets << " packets (" << stats.rxPacketsPerSec
+      << " per second), dropped " << stats.rxDroppedTotalPackets
+      << " (rx ring full " << stats.rxDroppedRxRingFullPackets
+      << ", fill ring empty " << stats.rxDroppedFillRingPackets
+      << ", invalid " << stats.rxDroppedInvalidPackets
+      << "), UMEM frames in use " << stats.umemAllocatedFrames
+      << "/" << (stats.umemAllocatedFrames + stats.umemFreeFrames);
+  ::std::lock_guard<::std::mutex> lock(statistics_mutex_);
+  statistics_ = result.str();
+}
+
+::std::string XdpCapturer::getStatistics() noexcept {
+  ::std::lock_guard<::std::mutex> lock(statistics_mutex_);
+  return statistics_;
+}
+
+
+}  // namespace flow_inspector
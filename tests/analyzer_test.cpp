@@ -1,12 +1,61 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <netinet/in.h>
+
 #include "analyzer.h"
 #include "debug_logger.h"
+#include "decapsulation.h"
 
 
 namespace flow_inspector {
 
 
+namespace {
+
+
+void appendBigEndian16(::std::vector<internal::byte>& data, size_t value) {
+  data.push_back(static_cast<internal::byte>(value >> 8));
+  data.push_back(static_cast<internal::byte>(value));
+}
+
+
+// Ethernet и IPv6 с 48 байтами destination options перед заголовком protocol
+::std::vector<internal::byte> wrapInIpv6(uint8_t protocol, const ::std::vector<internal::byte>& payload) {
+  constexpr size_t kOptionsSize{48};
+  ::std::vector<internal::byte> frame(12);
+  appendBigEndian16(frame, 0x86dd);
+  frame.insert(frame.end(), {0x60, 0, 0, 0});
+  appendBigEndian16(frame, kOptionsSize + payload.size());
+  frame.insert(frame.end(), {IPPROTO_DSTOPTS, 64});
+  frame.resize(frame.size() + 32, 1);
+  frame.insert(frame.end(), {protocol, kOptionsSize / 8 - 1, 1, kOptionsSize - 4});
+  frame.resize(frame.size() + kOptionsSize - 4);
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+
+// Ethernet, IPv4 с 40 байтами опций и TCP SYN
+::std::vector<internal::byte> makeTcpFrame(uint16_t src_port, uint16_t dst_port) {
+  ::std::vector<internal::byte> frame(12);
+  appendBigEndian16(frame, 0x0800);
+  frame.insert(frame.end(), {0x4f, 0});
+  appendBigEndian16(frame, 60 + 20);
+  frame.insert(frame.end(), {0, 0, 0, 0, 64, IPPROTO_TCP, 0, 0, 10, 0, 0, 1, 10, 0, 0, 2});
+  frame.resize(frame.size() + 40, 1);
+  appendBigEndian16(frame, src_port);
+  appendBigEndian16(frame, dst_port);
+  frame.insert(frame.end(), {0, 0, 0, 1, 0, 0, 0, 0, 0x50, 0x02, 0xff, 0xff, 0, 0, 0, 0});
+  return frame;
+}
+
+
+}  // namespace
+
+
 TEST(AnalyzerTest, LoadBadRule) {
   Logger logger;
   EventsHandler handler{logger};
@@ -169,4 +218,143 @@ TEST(AnalyzerTest, LoadTwoRulesWithSameSignature) {
 }
 
 
+TEST(AnalyzerTest, MarksPacketsMatchedByAlertRules) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  internal::Packet matched_packet{internal::rawPacketFromVector({0, 1, 2, 3, 4, 5, 6})};
+  internal::Packet non_matched_packet{internal::rawPacketFromVector({0, 1, 2, 4, 5, 6})};
+
+  // Alert; 1_sig; ([1 2 3 4])
+  EXPECT_TRUE(loadFile(analyzer, "1_sig.rule"));
+  analyzer.detectThreats(non_matched_packet);
+  analyzer.detectThreats(matched_packet);
+  EXPECT_FALSE(non_matched_packet.alerted);
+  EXPECT_TRUE(matched_packet.alerted);
+}
+
+
+TEST(AnalyzerTest, DoesNotMarkPacketsMatchedByOtherRules) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  internal::Packet packet{internal::rawPacketFromVector({0, 1, 2, 3, 4, 5, 6})};
+
+  // TestEvent1; rule_1; ([1 2], 1)
+  // TestEvent2; rule_2; ([1 2], 1)
+  EXPECT_TRUE(loadFile(analyzer, "2_rules_same_sig.rule"));
+  analyzer.detectThreats(packet);
+  EXPECT_FALSE(packet.alerted);
+}
+
+
+TEST(AnalyzerTest, CaptureFilterFromHeaderRules) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  EXPECT_EQ(analyzer.getCaptureFilter(), "");
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; web; ip([any],[10.0.0.0/16]); tcp([any], [80]); content(tcp, GET)"));
+  EXPECT_TRUE(analyzer.parseRule("Alert; ssh; tcp([22], [any])"));
+  EXPECT_EQ(analyzer.getCaptureFilter(),
+      "((ip and dst net 10.0.0.0/16) and (tcp dst port 80)) or ((tcp src port 22)) or "
+      "ip proto gre or ip6 proto gre or ip proto 4 or ip proto 41 or ip6 proto 4 or ip6 proto 41"
+      " or udp dst port 4789"
+      " or ether proto 0x8847 or ether proto 0x8848 or vlan");
+}
+
+
+TEST(AnalyzerTest, CaptureFilterDisabledByUnconstrainedRule) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; ssh; tcp([22], [any])"));
+  EXPECT_NE(analyzer.getCaptureFilter(), "");
+
+  EXPECT_TRUE(loadFile(analyzer, "1_sig.rule"));
+  EXPECT_EQ(analyzer.getCaptureFilter(), "");
+}
+
+
+
+TEST(AnalyzerTest, SnapshotLengthFromRules) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  EXPECT_EQ(analyzer.getSnapshotLength(), 0);
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; ssh; tcp([22], [any])"));
+  EXPECT_EQ(analyzer.getSnapshotLength(),
+      internal::kMaxLinkHeaderSize + internal::kMaxTunnelsHeaderSize + internal::kMaxIpHeaderSize
+      + internal::kMaxTcpHeaderSize);
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; magic; raw_bytes([1 2 3], 800)"));
+  EXPECT_EQ(analyzer.getSnapshotLength(), 803);
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; web; tcp([any], [80]); content(tcp, GET)"));
+  EXPECT_EQ(analyzer.getSnapshotLength(), 0);
+}
+
+
+TEST(AnalyzerTest, SnapshotLengthFullForSavedPackets) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  EXPECT_TRUE(analyzer.parseRule("SaveToPcap; ssh; tcp([22], [any])"));
+  EXPECT_EQ(analyzer.getSnapshotLength(), 0);
+}
+
+
+TEST(AnalyzerTest, SnapshotLengthCoversNestedTunnels) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+  EXPECT_TRUE(analyzer.parseRule("Alert; ssh; tcp([any], [22])"));
+
+  // VXLAN в IPv6 внутри GRE в IPv6: каждый уровень укладывается в запас на один туннель
+  const auto inner = makeTcpFrame(40000, 22);
+  ::std::vector<internal::byte> vxlan;
+  appendBigEndian16(vxlan, 12345);
+  appendBigEndian16(vxlan, internal::kVxlanPort);
+  appendBigEndian16(vxlan, 16 + inner.size());
+  vxlan.insert(vxlan.end(), {0, 0, 0x08, 0, 0, 0, 0, 0, 0x2a, 0});
+  vxlan.insert(vxlan.end(), inner.begin(), inner.end());
+  const auto inner_tunnel = wrapInIpv6(IPPROTO_UDP, vxlan);
+  ASSERT_LE(inner_tunnel.size() - inner.size(), internal::kMaxTunnelHeaderSize);
+
+  ::std::vector<internal::byte> gre{0xb0, 0};
+  appendBigEndian16(gre, 0x6558);
+  gre.resize(gre.size() + 12);
+  gre.insert(gre.end(), inner_tunnel.begin(), inner_tunnel.end());
+  auto frame = wrapInIpv6(IPPROTO_GRE, gre);
+  frame.resize(::std::min<size_t>(frame.size(), analyzer.getSnapshotLength()));
+
+  internal::Packet packet{internal::rawPacketFromVector(frame)};
+  EXPECT_EQ(packet.getView().depth, 2);
+  analyzer.detectThreats(packet);
+  EXPECT_TRUE(packet.alerted);
+}
+
+
+TEST(AnalyzerTest, HeadersUsedByRules) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  EXPECT_FALSE(analyzer.usesHeaders());
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; magic; raw_bytes([1 2 3], 400)"));
+  EXPECT_FALSE(analyzer.usesHeaders());
+
+  EXPECT_TRUE(analyzer.parseRule("Alert; ssh; tcp([22], [any])"));
+  EXPECT_TRUE(analyzer.usesHeaders());
+}
+
+
 }  // namespace flow_inspector
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "decapsulation.h"
+#include "ip_signature.h"
+#include "packet_blueprint.h"
+#include "tcp_signature.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+constexpr size_t kEthernetSize{14};
+constexpr size_t kIpv4Size{20};
+constexpr size_t kTcpSize{20};
+
+
+PacketBlueprint makeInnerBlueprint() {
+  PacketBlueprint blueprint;
+  blueprint.transport = PacketBlueprint::Transport::TCP;
+  blueprint.src_ip = 0xc0a80001;
+  blueprint.dst_ip = 0xc0a80002;
+  blueprint.src_port = 40000;
+  blueprint.dst_port = 80;
+  const ::std::string payload = "GET / HTTP/1.1";
+  blueprint.payload.assign(payload.begin(), payload.end());
+  return blueprint;
+}
+
+
+::std::vector<byte> wrapInIpv4(uint8_t protocol, const ::std::vector<byte>& payload) {
+  ::std::vector<byte> frame(kEthernetSize + kIpv4Size);
+  frame[12] = 0x08;
+  const size_t total_length = kIpv4Size + payload.size();
+  byte* ip = frame.data() + kEthernetSize;
+  ip[0] = 0x45;
+  ip[2] = static_cast<byte>(total_length >> 8);
+  ip[3] = static_cast<byte>(total_length);
+  ip[8] = 64;
+  ip[9] = protocol;
+  const byte addresses[] = {10, 0, 0, 1, 10, 0, 0, 2};
+  ::std::copy(::std::begin(addresses), ::std::end(addresses), ip + 12);
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  return frame;
+}
+
+
+Packet makePacket(const ::std::vector<byte>& frame) {
+  Packet packet{frame.data(), frame.size(), timespec{}, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, nullptr};
+  packet.parse();
+  return packet;
+}
+
+
+}  // namespace
+
+
+TEST(DecapsulationTest, PlainTcp) {
+  const auto frame = buildFrame(makeInnerBlueprint());
+  PacketView view;
+  ASSERT_TRUE(decapsulate(frame.data(), frame.size(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, view));
+
+  EXPECT_EQ(view.ip_version, 4);
+  EXPECT_EQ(view.protocol, IPPROTO_TCP);
+  EXPECT_EQ(view.ip_offset, kEthernetSize);
+  EXPECT_EQ(view.outer_ip_offset, kEthernetSize);
+  EXPECT_EQ(view.l4_offset, kEthernetSize + kIpv4Size);
+  EXPECT_EQ(view.payload.data(), frame.data() + kEthernetSize + kIpv4Size + kTcpSize);
+  EXPECT_EQ(view.payload.size(), 14);
+  EXPECT_EQ(view.src_ip, 0xc0a80001);
+  EXPECT_EQ(view.dst_ip, 0xc0a80002);
+  EXPECT_EQ(view.src_port, 40000);
+  EXPECT_EQ(view.dst_port, 80);
+  EXPECT_EQ(view.tcp_flags, frame[kEthernetSize + kIpv4Size + 13]);
+  EXPECT_EQ(view.tunnel, PacketView::Tunnel::None);
+  EXPECT_EQ(view.depth, 0);
+}
+
+
+TEST(DecapsulationTest, QinQTags) {
+  auto frame = buildFrame(makeInnerBlueprint());
+  const byte tags[] = {0x88, 0xa8, 0x00, 0x64, 0x81, 0x00, 0x00, 0x0a};
+  frame.insert(frame.begin() + 12, ::std::begin(tags), ::std::end(tags));
+  PacketView view;
+  ASSERT_TRUE(decapsulate(frame.data(), frame.size(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, view));
+
+  EXPECT_EQ(view.vlan_id, 100);
+  EXPECT_EQ(view.ip_offset, kEthernetSize + sizeof(tags));
+  EXPECT_EQ(view.protocol, IPPROTO_TCP);
+}
+
+
+TEST(DecapsulationTest, VxlanInnerHeaders) {
+  const auto inner = buildFrame(makeInnerBlueprint());
+  ::std::vector<byte> udp{0x30, 0x39, 0x12, 0xb5, 0, 0, 0, 0, 0x08, 0, 0, 0, 0x00, 0x00, 0x2a, 0};
+  const size_t udp_length = udp.size() + inner.size();
+  udp[4] = static_cast<byte>(udp_length >> 8);
+  udp[5] = static_cast<byte>(udp_length);
+  udp.insert(udp.end(), inner.begin(), inner.end());
+  const auto frame = wrapInIpv4(IPPROTO_UDP, udp);
+
+  const auto packet = makePacket(frame);
+  const auto& view = packet.getView();
+  const size_t inner_offset = kEthernetSize + kIpv4Size + 16;
+  EXPECT_EQ(view.tunnel, PacketView::Tunnel::VXLAN);
+  EXPECT_EQ(view.tunnel_id, 42);
+  EXPECT_EQ(view.depth, 1);
+  EXPECT_EQ(view.outer_ip_offset, kEthernetSize);
+  EXPECT_EQ(view.ip_offset, inner_offset + kEthernetSize);
+  EXPECT_EQ(view.protocol, IPPROTO_TCP);
+
+  EXPECT_TRUE(TCPSignature(0, 80).check(packet));
+  EXPECT_TRUE(IPSignature({}, {{0xc0a80002, 0xffffffff}}).check(packet));
+  EXPECT_FALSE(IPSignature({}, {{0x0a000002, 0xffffffff}}).check(packet));
+}
+
+
+TEST(DecapsulationTest, GreWithKeyAndIpPayload) {
+  const auto inner = buildFrame(makeInnerBlueprint());
+  ::std::vector<byte> gre{0x20, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x07};
+  gre.insert(gre.end(), inner.begin() + kEthernetSize, inner.end());
+  const auto frame = wrapInIpv4(IPPROTO_GRE, gre);
+
+  const auto packet = makePacket(frame);
+  const auto& view = packet.getView();
+  EXPECT_EQ(view.tunnel, PacketView::Tunnel::GRE);
+  EXPECT_EQ(view.tunnel_id, 7);
+  EXPECT_EQ(view.ip_offset, kEthernetSize + kIpv4Size + gre.size() - (inner.size() - kEthernetSize));
+  EXPECT_EQ(view.payload.size(), 14);
+  EXPECT_TRUE(TCPSignature(40000, 80).check(packet));
+}
+
+
+TEST(DecapsulationTest, TruncatedFrameKeepsIpOnly) {
+  auto frame = buildFrame(makeInnerBlueprint());
+  frame.resize(kEthernetSize + kIpv4Size + 4);
+  PacketView view;
+  ASSERT_TRUE(decapsulate(frame.data(), frame.size(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, view));
+
+  EXPECT_EQ(view.ip_version, 4);
+  EXPECT_EQ(view.l4_offset, 0);
+}
+
+
+TEST(DecapsulationTest, LinkDecodersFindTheSameHeaders) {
+  const auto ethernet = buildFrame(makeInnerBlueprint());
+  const ::std::vector<byte> ip(ethernet.begin() + kEthernetSize, ethernet.end());
+
+  ::std::vector<byte> sll2(20);
+  sll2[0] = 0x08;
+  sll2.insert(sll2.end(), ip.begin(), ip.end());
+  ::std::vector<byte> loopback{2, 0, 0, 0};
+  loopback.insert(loopback.end(), ip.begin(), ip.end());
+
+  const ::std::pair<::pcpp::LinkLayerType, const ::std::vector<byte>*> frames[] = {
+    {::pcpp::LinkLayerType::LINKTYPE_ETHERNET, &ethernet},
+    {::pcpp::LinkLayerType::LINKTYPE_RAW, &ip},
+    {::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL2, &sll2},
+    {::pcpp::LinkLayerType::LINKTYPE_NULL, &loopback},
+    {::pcpp::LinkLayerType::LINKTYPE_LOOP, &loopback},
+  };
+  for (const auto& [link_type, frame] : frames) {
+    PacketView view;
+    ASSERT_TRUE(selectLinkDecoder(link_type)(frame->data(), frame->size(), view)) << link_type;
+    EXPECT_EQ(view.ip_offset, frame->size() - ip.size());
+    EXPECT_EQ(view.src_port, 40000);
+    EXPECT_EQ(view.payload.size(), 14);
+  }
+
+  PacketView view;
+  EXPECT_FALSE(selectLinkDecoder(::pcpp::LinkLayerType::LINKTYPE_IEEE802_11)(ethernet.data(), ethernet.size(), view));
+  EXPECT_EQ(view.ip_version, 0);
+}
+
+
+TEST(DecapsulationTest, RetainHeadersAndPayloadPrefix) {
+  const auto frame = buildFrame(makeInnerBlueprint());
+  const auto packet = makePacket(frame);
+  const size_t headers_length = kEthernetSize + kIpv4Size + kTcpSize;
+
+  const auto headers = packet.retain(0);
+  EXPECT_EQ(headers->packet->getRawDataLen(), headers_length);
+  EXPECT_EQ(headers->packet->getFrameLength(), frame.size());
+  EXPECT_TRUE(TCPSignature(40000, 80).check(*headers));
+
+  const auto prefix = packet.retain(3);
+  ASSERT_EQ(prefix->packet->getRawDataLen(), headers_length + 3);
+  EXPECT_EQ(::std::string(prefix->getView().payload.begin(), prefix->getView().payload.end()), "GET");
+
+  EXPECT_EQ(packet.retain(100), packet.share());
+  EXPECT_EQ(packet.retain(::std::nullopt), packet.share());
+  EXPECT_EQ(*packet.share(), packet);
+}
+
+
+}  // namespace flow_inspector::internal
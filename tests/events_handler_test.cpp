@@ -122,4 +122,62 @@ TEST(EventsHandlerTest, PassEventObjectToCallback) {
   events_handler.addEvent(test_event);
 }
 
+TEST(EventsHandlerTest, DeferredEventsAreDispatchedOnCommit) {
+  Logger logger;
+  EventsHandler events_handler{logger};
+  ::std::vector<::std::string> dispatched;
+
+  events_handler.addEventCallback(internal::Event::EventType::TestEvent,
+      [&dispatched](const internal::Event& event) {
+        dispatched.push_back(event.rule.getName() + event.packet.toString());
+      });
+
+  DeferredEvents deferred;
+  EventsHandler::deferEvents(&deferred);
+  for (internal::byte i = 1; i <= 2; ++i) {
+    internal::Packet packet{internal::rawPacketFromVector({i})};
+    events_handler.addEvent(internal::Event{
+      .type = internal::Event::EventType::TestEvent,
+      .rule = internal::Rule{"TestRule", internal::Event::EventType::TestEvent},
+      .packet = packet,
+    });
+  }
+  EventsHandler::deferEvents(nullptr);
+
+  EXPECT_TRUE(dispatched.empty());
+  EXPECT_EQ(deferred.size(), 2);
+
+  deferred.commit();
+  EXPECT_EQ(dispatched, (::std::vector<::std::string>{"TestRule[1]", "TestRule[2]"}));
+  EXPECT_EQ(deferred.size(), 0);
+}
+
+TEST(EventsHandlerTest, DeferredEventsShareThePacket) {
+  Logger logger;
+  EventsHandler events_handler{logger};
+  const internal::byte* pooled_data = nullptr;
+  const internal::byte* dispatched_data = nullptr;
+
+  events_handler.addEventCallback(internal::Event::EventType::TestEvent,
+      [&dispatched_data](const internal::Event& event) {
+        dispatched_data = event.packet.packet->getRawData();
+      });
+
+  DeferredEvents deferred;
+  EventsHandler::deferEvents(&deferred);
+  {
+    internal::Packet packet{internal::rawPacketFromVector({1, 2, 3})};
+    pooled_data = packet.packet->getRawData();
+    events_handler.addEvent(internal::Event{
+      .type = internal::Event::EventType::TestEvent,
+      .rule = internal::Rule{"TestRule", internal::Event::EventType::TestEvent},
+      .packet = packet,
+    });
+  }
+  EventsHandler::deferEvents(nullptr);
+
+  deferred.commit();
+  EXPECT_EQ(dispatched_data, pooled_data);
+}
+
 }  // namespace flow_inspector
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "fanout_capturer.h"
+#include "packet_ring.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+constexpr uint16_t kTestPort{47812};
+
+
+}  // namespace
+
+
+TEST(FanoutCapturerTest, InterfacesGetDistinctGroups) {
+  ::std::set<uint16_t> used;
+  const auto first = FanoutCapturer::chooseGroupId(1234, 1, used);
+  used.insert(first);
+  const auto second = FanoutCapturer::chooseGroupId(1234, 2, used);
+  EXPECT_NE(first, second);
+  used.insert(second);
+
+  // Совпадение с уже занятой группой разрешается переходом к следующему свободному идентификатору
+  const auto colliding = FanoutCapturer::chooseGroupId(1234, 1, used);
+  EXPECT_FALSE(used.contains(colliding));
+}
+
+
+TEST(FanoutCapturerTest, MissingInterfaceFails) {
+  FanoutCapturer capturer;
+  capturer.setInterfaceName("flow-inspector-missing0");
+  capturer.startReading();
+  EXPECT_TRUE(capturer.hasFailed());
+}
+
+
+TEST(FanoutCapturerTest, WorkersShareLoopbackTraffic) {
+  {
+    internal::PacketRing probe;
+    if (!probe.open("lo", internal::PacketRing::Config{.block_size = 1u << 16, .block_count = 2})) {
+      GTEST_SKIP() << "AF_PACKET sockets need CAP_NET_RAW";
+    }
+  }
+
+  FanoutCapturer capturer;
+  capturer.setInterfaceName("lo");
+  capturer.setRingConfig(internal::PacketRing::Config{
+    .block_size = 1u << 16,
+    .block_count = 4,
+    .frame_size = 2048,
+    .retire_timeout_ms = 10,
+  });
+  capturer.setWorkersCount(2);
+  capturer.setCaptureFilter("udp port " + ::std::to_string(kTestPort));
+  EXPECT_TRUE(capturer.hasOwnWorkers());
+
+  ::std::atomic<size_t> received{0};
+  capturer.setBatchProcessor([&received](::std::span<internal::Packet> packets) {
+    received.fetch_add(packets.size());
+  });
+  ::std::thread reader{[&capturer]() {
+    capturer.startReading();
+  }};
+
+  int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(kTestPort);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  const char payload[] = "fanout";
+  const auto deadline = ::std::chrono::steady_clock::now() + ::std::chrono::seconds(5);
+  while (received.load() == 0 && ::std::chrono::steady_clock::now() < deadline) {
+    ::sendto(fd, payload, sizeof(payload), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::std::this_thread::sleep_for(::std::chrono::milliseconds(20));
+  }
+  ::close(fd);
+  capturer.stopReading();
+  reader.join();
+
+  EXPECT_GT(received.load(), 0);
+  PacketOrigin::CaptureStatistics statistics;
+  ASSERT_TRUE(capturer.getCaptureStatistics(statistics));
+  EXPECT_GE(statistics.received, received.load());
+}
+
+
+}  // namespace flow_inspector
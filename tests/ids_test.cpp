@@ -4,6 +4,7 @@
 
 #include "ids.h"
 #include "logger.h"
+#include "parallel_pcap_reader.h"
 #include "pcap_reader.h"
 
 
@@ -171,4 +172,39 @@ TEST(IDSTest, ALotOfPacketsWithSaving) {
 }
 
 
+TEST(IDSTest, ChunkedReadingKeepsPacketOrder) {
+  const ::std::string testOutputFilename = "test_output5.log";
+  const ::std::string testPcapOutputFilename = "test_output5.pcap";
+
+  {
+    auto reader = ::std::make_unique<ParallelPcapReader>();
+    reader->setFilename("a_lot_of.pcap");
+    reader->setWorkersCount(4);
+    reader->setChunkSize(7);
+    IDS ids{4, ::std::move(reader)};
+    ids.setOutputFilename(testOutputFilename);
+    ids.setPcapOutputFilename(testPcapOutputFilename);
+    ids.setLogLevel(Logger::LogLevel::INFO);
+    ids.loadRules("pcap_all.rule");
+    ids.start();
+  }
+
+  auto readPackets = [](const ::std::string& filename) {
+    PcapReader reader;
+    reader.setFilename(filename);
+    ::std::vector<::std::string> packets;
+    reader.setProcessor([&packets](const internal::Packet& packet) {
+      packets.push_back(packet.toString());
+    });
+    reader.startReading();
+    return packets;
+  };
+
+  const auto expected = readPackets("a_lot_of.pcap");
+  const auto saved = readPackets(testPcapOutputFilename);
+  EXPECT_GT(expected.size(), 7);
+  EXPECT_EQ(saved, expected);
+}
+
+
 }  // namespace flow_inspector::internal
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include "mmap_pcap_reader.h"
+#include "pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+TEST(MmapPcapReaderTest, ReadEmptyPcap) {
+  MmapPcapReader reader;
+  bool processorCalled = false;
+
+  reader.setProcessor([&processorCalled](internal::Packet) {
+    processorCalled = true;
+  });
+
+  reader.setFilename("empty.pcap");
+  reader.startReading();
+
+  EXPECT_FALSE(processorCalled);
+}
+
+
+TEST(MmapPcapReaderTest, ReadMissingFile) {
+  MmapPcapReader reader;
+  bool processorCalled = false;
+
+  reader.setProcessor([&processorCalled](internal::Packet) {
+    processorCalled = true;
+  });
+
+  reader.setFilename("no_such_file.pcap");
+  reader.startReading();
+
+  EXPECT_FALSE(processorCalled);
+}
+
+
+TEST(MmapPcapReaderTest, ReadDoublePackets) {
+  MmapPcapReader reader;
+  ::std::vector<internal::Packet> capturedPackets;
+
+  reader.setProcessor([&capturedPackets](internal::Packet packet) {
+    capturedPackets.push_back(::std::move(packet));
+  });
+
+  reader.setFilename("double_packets.pcap");
+  reader.startReading();
+
+  ASSERT_EQ(capturedPackets.size(), 2);
+  EXPECT_EQ(reader.getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_LINUX_SLL2);
+
+  // Пакеты остаются валидными после окончания чтения, пока держат отображение файла
+  EXPECT_EQ(capturedPackets[0].toString(),
+      "[8 0 0 0 0 0 0 1 3 4 0 6 0 0 0 0 0 0 0 0 69 0 0 60 152 151 64 0 64 6 164 34 127 0 0 1 127 "
+      "0 0 1 140 186 52 66 20 28 45 199 0 0 0 0 160 2 255 215 254 48 0 0 2 4 255 215 4 2 8 10 226"
+      " 115 227 101 0 0 0 0 1 3 3 7]");
+  EXPECT_EQ(capturedPackets[1].toString(),
+      "[8 0 0 0 0 0 0 1 3 4 0 6 0 0 0 0 0 0 0 0 69 0 0 40 0 0 64 0 64 6 60 206 127 0 0 1 127 0 0 "
+      "1 52 66 140 186 0 0 0 0 20 28 45 200 80 20 0 0 174 237 0 0]");
+}
+
+
+TEST(MmapPcapReaderTest, SameAsPcapReader) {
+  ::std::vector<internal::Packet> expectedPackets;
+  PcapReader pcapReader;
+  pcapReader.setProcessor([&expectedPackets](internal::Packet packet) {
+    expectedPackets.push_back(::std::move(packet));
+  });
+  pcapReader.setFilename("a_lot_of.pcap");
+  pcapReader.startReading();
+
+  ::std::vector<internal::Packet> capturedPackets;
+  MmapPcapReader mmapReader;
+  mmapReader.setProcessor([&capturedPackets](internal::Packet packet) {
+    capturedPackets.push_back(::std::move(packet));
+  });
+  mmapReader.setFilename("a_lot_of.pcap");
+  mmapReader.startReading();
+
+  EXPECT_EQ(mmapReader.getLinkLayerType(), pcapReader.getLinkLayerType());
+  ASSERT_EQ(capturedPackets.size(), expectedPackets.size());
+  for (size_t i = 0; i < capturedPackets.size(); ++i) {
+    EXPECT_EQ(capturedPackets[i], expectedPackets[i]);
+    EXPECT_EQ(capturedPackets[i].packet->getPacketTimeStamp().tv_sec,
+        expectedPackets[i].packet->getPacketTimeStamp().tv_sec);
+    EXPECT_EQ(capturedPackets[i].packet->getPacketTimeStamp().tv_nsec,
+        expectedPackets[i].packet->getPacketTimeStamp().tv_nsec);
+  }
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "multi_interface_capturer.h"
+#include "pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+class StubCapturer : public PacketOrigin {
+ public:
+  StubCapturer(::pcpp::LinkLayerType link_type, uint64_t received, uint64_t kernel_drops) noexcept
+    : link_type_{link_type}
+    , received_{received}
+    , kernel_drops_{kernel_drops}
+  {}
+
+  void startReading() noexcept override {
+    setCaptureStatistics(CaptureStatistics{.received = received_, .kernel_drops = kernel_drops_});
+  }
+
+  void internalStopReading() noexcept override {}
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override {
+    return link_type_;
+  }
+
+ private:
+  ::pcpp::LinkLayerType link_type_;
+  uint64_t received_;
+  uint64_t kernel_drops_;
+};
+
+
+class FailingCapturer : public PacketOrigin {
+ public:
+  void startReading() noexcept override {
+    markFailed();
+  }
+
+  void internalStopReading() noexcept override {}
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override {
+    return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+};
+
+
+class BlockingCapturer : public PacketOrigin {
+ public:
+  void startReading() noexcept override {
+    while (!isDoneReading()) {
+      ::std::this_thread::sleep_for(::std::chrono::milliseconds(1));
+    }
+  }
+
+  void internalStopReading() noexcept override {}
+
+  ::pcpp::LinkLayerType getLinkLayerType() noexcept override {
+    return ::pcpp::LinkLayerType::LINKTYPE_ETHERNET;
+  }
+};
+
+
+::std::unique_ptr<PacketOrigin> makeReader(const ::std::string& filename) {
+  auto reader = ::std::make_unique<PcapReader>();
+  reader->setFilename(filename);
+  return reader;
+}
+
+
+size_t countPackets(PacketOrigin& origin) {
+  ::std::mutex mutex;
+  size_t count = 0;
+  origin.setProcessor([&mutex, &count](internal::Packet) {
+    ::std::lock_guard<::std::mutex> lock(mutex);
+    ++count;
+  });
+  origin.getLinkLayerType();
+  origin.startReading();
+  return count;
+}
+
+
+}  // namespace
+
+
+TEST(MultiInterfaceCapturerTest, FeedsOneProcessor) {
+  MultiInterfaceCapturer capturer;
+  capturer.addInterface("eth1", makeReader("a_lot_of.pcap"));
+  capturer.addInterface("eth2", makeReader("http.pcap"));
+  const auto merged_count = countPackets(capturer);
+
+  auto first = makeReader("a_lot_of.pcap");
+  auto second = makeReader("http.pcap");
+  EXPECT_EQ(merged_count, countPackets(*first) + countPackets(*second));
+}
+
+
+TEST(MultiInterfaceCapturerTest, PerInterfaceStatistics) {
+  MultiInterfaceCapturer capturer;
+  capturer.addInterface("eth1", ::std::make_unique<StubCapturer>(
+      ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, 10, 1));
+  capturer.addInterface("eth2", ::std::make_unique<StubCapturer>(
+      ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, 20, 2));
+  countPackets(capturer);
+
+  PacketOrigin::CaptureStatistics statistics;
+  ASSERT_TRUE(capturer.getCaptureStatistics(statistics));
+  EXPECT_EQ(statistics.received, 30);
+  EXPECT_EQ(statistics.kernel_drops, 3);
+
+  const auto report = capturer.getStatistics();
+  EXPECT_NE(report.find("Interface eth1: received 10, dropped by kernel 1"), ::std::string::npos);
+  EXPECT_NE(report.find("Interface eth2: received 20, dropped by kernel 2"), ::std::string::npos);
+}
+
+
+TEST(MultiInterfaceCapturerTest, RefusesDifferentLinkTypes) {
+  MultiInterfaceCapturer capturer;
+  capturer.addInterface("eth1", ::std::make_unique<StubCapturer>(
+      ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, 10, 0));
+  capturer.addInterface("tun0", ::std::make_unique<StubCapturer>(
+      ::pcpp::LinkLayerType::LINKTYPE_RAW, 20, 0));
+  EXPECT_EQ(capturer.getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET);
+  capturer.startReading();
+
+  PacketOrigin::CaptureStatistics statistics;
+  EXPECT_FALSE(capturer.getCaptureStatistics(statistics));
+  EXPECT_TRUE(capturer.hasFailed());
+}
+
+
+TEST(MultiInterfaceCapturerTest, StopsAllInterfacesWhenOneFails) {
+  MultiInterfaceCapturer capturer;
+  auto healthy = ::std::make_unique<BlockingCapturer>();
+  auto* healthy_capturer = healthy.get();
+  capturer.addInterface("eth1", ::std::move(healthy));
+  capturer.addInterface("eth2", ::std::make_unique<FailingCapturer>());
+  capturer.getLinkLayerType();
+  capturer.startReading();
+
+  EXPECT_TRUE(capturer.hasFailed());
+  EXPECT_TRUE(healthy_capturer->isDoneReading());
+  EXPECT_FALSE(healthy_capturer->hasFailed());
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "multi_pcap_reader.h"
+#include "pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+::std::vector<internal::Packet> readAll(PacketOrigin& reader) {
+  ::std::vector<internal::Packet> packets;
+  reader.setProcessor([&packets](internal::Packet packet) {
+    packets.push_back(::std::move(packet));
+  });
+  reader.startReading();
+  return packets;
+}
+
+
+bool isOrderedByTimestamp(const ::std::vector<internal::Packet>& packets) {
+  for (size_t i = 1; i < packets.size(); ++i) {
+    const auto& previous = packets[i - 1].packet->getPacketTimeStamp();
+    const auto& current = packets[i].packet->getPacketTimeStamp();
+    if (current.tv_sec < previous.tv_sec
+        || (current.tv_sec == previous.tv_sec && current.tv_nsec < previous.tv_nsec)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+}  // namespace
+
+
+TEST(MultiPcapReaderTest, ResolveFileList) {
+  EXPECT_EQ(MultiPcapReader::resolveInputs("single_packet.pcap,double_packets.pcap"),
+      (::std::vector<::std::string>{"single_packet.pcap", "double_packets.pcap"}));
+}
+
+
+TEST(MultiPcapReaderTest, ResolveGlobAndDirectory) {
+  EXPECT_EQ(MultiPcapReader::resolveInputs("*_packet*.pcap"),
+      (::std::vector<::std::string>{"double_packets.pcap", "single_packet.pcap"}));
+
+  ::std::filesystem::create_directory("multi_pcap_dir");
+  ::std::filesystem::copy_file("single_packet.pcap", "multi_pcap_dir/b.pcap",
+      ::std::filesystem::copy_options::overwrite_existing);
+  ::std::filesystem::copy_file("double_packets.pcap", "multi_pcap_dir/a.pcap",
+      ::std::filesystem::copy_options::overwrite_existing);
+  EXPECT_EQ(MultiPcapReader::resolveInputs("multi_pcap_dir"),
+      (::std::vector<::std::string>{"multi_pcap_dir/a.pcap", "multi_pcap_dir/b.pcap"}));
+  ::std::filesystem::remove_all("multi_pcap_dir");
+}
+
+
+TEST(MultiPcapReaderTest, MergeByTimestamp) {
+  MultiPcapReader reader;
+  reader.setFilenames({"http.pcap", "double_packets.pcap", "a_lot_of.pcap", "empty.pcap"});
+  reader.setReadersCount(2);
+  auto merged = readAll(reader);
+
+  size_t expected_count = 0;
+  for (const auto& filename : {"http.pcap", "double_packets.pcap", "a_lot_of.pcap"}) {
+    PcapReader single;
+    single.setFilename(filename);
+    expected_count += readAll(single).size();
+  }
+
+  EXPECT_EQ(merged.size(), expected_count);
+  EXPECT_TRUE(isOrderedByTimestamp(merged));
+}
+
+
+TEST(MultiPcapReaderTest, SingleFileMatchesPcapReader) {
+  MultiPcapReader reader;
+  reader.setFilenames({"a_lot_of.pcap"});
+  auto merged = readAll(reader);
+
+  PcapReader single;
+  single.setFilename("a_lot_of.pcap");
+  auto expected = readAll(single);
+
+  EXPECT_EQ(merged, expected);
+}
+
+
+TEST(MultiPcapReaderTest, StopWhileRefillsArePending) {
+  MultiPcapReader reader;
+  reader.setFilenames({"http.pcap", "a_lot_of.pcap", "double_packets.pcap"});
+  reader.setReadersCount(3);
+  size_t count = 0;
+  reader.setProcessor([&reader, &count](internal::Packet) {
+    if (++count == 10) {
+      reader.stopReading();
+    }
+  });
+  reader.startReading();
+
+  size_t total_count = 0;
+  for (const auto& filename : {"http.pcap", "a_lot_of.pcap", "double_packets.pcap"}) {
+    PcapReader single;
+    single.setFilename(filename);
+    total_count += readAll(single).size();
+  }
+  EXPECT_LT(count, total_count);
+}
+
+
+TEST(MultiPcapReaderTest, RefusesDifferentLinkTypes) {
+  // Тот же файл с типом канального уровня RAW в заголовке
+  ::std::filesystem::copy_file("single_packet.pcap", "raw_link.pcap",
+      ::std::filesystem::copy_options::overwrite_existing);
+  {
+    ::std::fstream file("raw_link.pcap", ::std::ios::in | ::std::ios::out | ::std::ios::binary);
+    file.seekp(20);
+    const char link_type[4] = {101, 0, 0, 0};
+    file.write(link_type, sizeof(link_type));
+  }
+
+  MultiPcapReader reader;
+  reader.setFilenames({"single_packet.pcap", "raw_link.pcap"});
+  EXPECT_NE(reader.getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_RAW);
+  EXPECT_TRUE(readAll(reader).empty());
+  ::std::filesystem::remove("raw_link.pcap");
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nfnetlink_queue.h>
+#include <linux/netlink.h>
+
+#include "internal_structs.h"
+#include "netfilter_queue.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+using Attributes = ::std::vector<::std::pair<uint16_t, ::std::vector<internal::byte>>>;
+
+
+template <typename T>
+::std::vector<internal::byte> toBytes(const T& value) {
+  ::std::vector<internal::byte> bytes(sizeof(value));
+  ::std::memcpy(bytes.data(), &value, sizeof(value));
+  return bytes;
+}
+
+
+// Дописывает сообщение так, как его собирает ядро: nlmsghdr, nfgenmsg и выровненные атрибуты
+void appendMessage(::std::vector<internal::byte>& buffer, uint16_t type, const Attributes& attributes) {
+  const size_t start = buffer.size();
+  buffer.resize(start + NLMSG_HDRLEN + NLMSG_ALIGN(sizeof(nfgenmsg)));
+  for (const auto& [attribute_type, data] : attributes) {
+    const size_t offset = buffer.size();
+    buffer.resize(offset + NLA_ALIGN(NLA_HDRLEN + data.size()));
+    const nlattr attribute{.nla_len = static_cast<uint16_t>(NLA_HDRLEN + data.size()), .nla_type = attribute_type};
+    ::std::memcpy(buffer.data() + offset, &attribute, sizeof(attribute));
+    ::std::memcpy(buffer.data() + offset + NLA_HDRLEN, data.data(), data.size());
+  }
+  const nlmsghdr header{
+    .nlmsg_len = static_cast<uint32_t>(buffer.size() - start),
+    .nlmsg_type = type,
+    .nlmsg_flags = 0,
+    .nlmsg_seq = 0,
+    .nlmsg_pid = 0,
+  };
+  ::std::memcpy(buffer.data() + start, &header, sizeof(header));
+}
+
+
+::std::vector<internal::byte> packetHeader(uint32_t id) {
+  nfqnl_msg_packet_hdr header{};
+  header.packet_id = htonl(id);
+  header.hw_protocol = htons(0x0800);
+  header.hook = NF_INET_FORWARD;
+  return toBytes(header);
+}
+
+
+struct ParsedMessage {
+  uint16_t type;
+  uint16_t queue_number;
+  uint32_t sequence;
+  ::std::vector<::std::pair<uint16_t, ::std::vector<internal::byte>>> attributes;
+};
+
+
+::std::vector<ParsedMessage> parseMessages(const ::std::vector<internal::byte>& buffer) {
+  ::std::vector<ParsedMessage> messages;
+  const auto* header = reinterpret_cast<const nlmsghdr*>(buffer.data());
+  int remaining = static_cast<int>(buffer.size());
+  for (; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+    nfgenmsg generic;
+    ::std::memcpy(&generic, reinterpret_cast<const internal::byte*>(header) + NLMSG_HDRLEN, sizeof(generic));
+    ParsedMessage message{
+      .type = header->nlmsg_type,
+      .queue_number = ntohs(generic.res_id),
+      .sequence = header->nlmsg_seq,
+      .attributes = {},
+    };
+    size_t offset = NLMSG_HDRLEN + NLMSG_ALIGN(sizeof(nfgenmsg));
+    while (offset + NLA_HDRLEN <= header->nlmsg_len) {
+      nlattr attribute;
+      ::std::memcpy(&attribute, reinterpret_cast<const internal::byte*>(header) + offset, sizeof(attribute));
+      const auto* data = reinterpret_cast<const internal::byte*>(header) + offset + NLA_HDRLEN;
+      message.attributes.emplace_back(attribute.nla_type,
+          ::std::vector<internal::byte>(data, data + attribute.nla_len - NLA_HDRLEN));
+      offset += NLA_ALIGN(attribute.nla_len);
+    }
+    messages.push_back(::std::move(message));
+  }
+  EXPECT_EQ(remaining, 0);
+  return messages;
+}
+
+
+uint32_t readBigEndian32(const ::std::vector<internal::byte>& data) {
+  uint32_t value;
+  ::std::memcpy(&value, data.data(), sizeof(value));
+  return ntohl(value);
+}
+
+
+constexpr uint16_t kPacketMessage{(NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_PACKET};
+
+
+}  // namespace
+
+
+TEST(NetfilterQueueTest, ParsePacketMessages) {
+  ::std::vector<internal::byte> buffer;
+  const ::std::vector<internal::byte> first{0x45, 1, 2, 3};
+  const ::std::vector<internal::byte> second{0x45, 4, 5};
+  nfqnl_msg_packet_timestamp timestamp{.sec = htobe64(1700000000), .usec = htobe64(250)};
+  appendMessage(buffer, kPacketMessage, {
+    {NFQA_PACKET_HDR, packetHeader(7)},
+    {NFQA_TIMESTAMP, toBytes(timestamp)},
+    {NFQA_PAYLOAD, first},
+  });
+  // Сообщение без содержимого пакета и сообщение другого типа пропускаются
+  appendMessage(buffer, kPacketMessage, {{NFQA_PACKET_HDR, packetHeader(8)}});
+  appendMessage(buffer, (NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_CONFIG, {{NFQA_PAYLOAD, first}});
+  appendMessage(buffer, kPacketMessage, {
+    {NFQA_PAYLOAD, second},
+    {NFQA_PACKET_HDR | NLA_F_NESTED, packetHeader(9)},
+  });
+
+  bool released = false;
+  ::std::vector<uint32_t> ids;
+  ::std::vector<internal::Packet> packets;
+  {
+    ::std::shared_ptr<const void> holder(buffer.data(), [&released](const void*) { released = true; });
+    const timespec now{.tv_sec = 42, .tv_nsec = 0};
+    const auto count = internal::NetfilterQueue::parsePackets(buffer.data(), buffer.size(), now, holder,
+        [&ids, &packets](uint32_t id, internal::Packet packet) {
+          ids.push_back(id);
+          packets.push_back(::std::move(packet));
+        });
+    EXPECT_EQ(count, 2);
+  }
+
+  ASSERT_EQ(ids, (::std::vector<uint32_t>{7, 9}));
+  EXPECT_EQ(packets[0].toString(), "[69 1 2 3]");
+  EXPECT_EQ(packets[1].toString(), "[69 4 5]");
+  EXPECT_EQ(packets[0].packet->getPacketTimeStamp().tv_sec, 1700000000);
+  EXPECT_EQ(packets[0].packet->getPacketTimeStamp().tv_nsec, 250000);
+  EXPECT_EQ(packets[1].packet->getPacketTimeStamp().tv_sec, 42);
+  EXPECT_EQ(packets[1].packet->getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_RAW);
+  EXPECT_FALSE(released);
+  packets.clear();
+  EXPECT_TRUE(released);
+}
+
+
+TEST(NetfilterQueueTest, ParseTruncatedAttribute) {
+  ::std::vector<internal::byte> buffer;
+  appendMessage(buffer, kPacketMessage, {
+    {NFQA_PACKET_HDR, packetHeader(1)},
+    {NFQA_PAYLOAD, {0x45, 0, 0, 0}},
+  });
+  // Длина атрибута нагрузки выходит за границу сообщения
+  const size_t payload_attribute = buffer.size() - NLA_ALIGN(NLA_HDRLEN + 4);
+  const uint16_t broken_length = 200;
+  ::std::memcpy(buffer.data() + payload_attribute, &broken_length, sizeof(broken_length));
+
+  const auto count = internal::NetfilterQueue::parsePackets(buffer.data(), buffer.size(), timespec{}, nullptr,
+      [](uint32_t, internal::Packet) {
+        ADD_FAILURE();
+      });
+  EXPECT_EQ(count, 0);
+}
+
+
+TEST(NetfilterQueueTest, BuildVerdicts) {
+  ::std::vector<internal::byte> message;
+  uint32_t sequence = 10;
+  const ::std::vector<uint32_t> dropped{3, 5};
+  internal::NetfilterQueue::buildVerdicts(message, sequence, 2, dropped, 9);
+  EXPECT_EQ(sequence, 13);
+
+  const auto messages = parseMessages(message);
+  ASSERT_EQ(messages.size(), 3);
+  const uint16_t verdict_type = (NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_VERDICT;
+  const uint16_t batch_type = (NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_VERDICT_BATCH;
+  const ::std::vector<::std::tuple<uint16_t, uint32_t, uint32_t>> expected{
+    {verdict_type, NF_DROP, 3},
+    {verdict_type, NF_DROP, 5},
+    {batch_type, NF_ACCEPT, 9},
+  };
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const auto& [type, verdict, id] = expected[i];
+    EXPECT_EQ(messages[i].type, type);
+    EXPECT_EQ(messages[i].queue_number, 2);
+    EXPECT_EQ(messages[i].sequence, 11 + i);
+    ASSERT_EQ(messages[i].attributes.size(), 1);
+    EXPECT_EQ(messages[i].attributes[0].first, NFQA_VERDICT_HDR);
+    nfqnl_msg_verdict_hdr header;
+    ::std::memcpy(&header, messages[i].attributes[0].second.data(), sizeof(header));
+    EXPECT_EQ(ntohl(header.verdict), verdict);
+    EXPECT_EQ(ntohl(header.id), id);
+  }
+
+  // Пачка без отброшенных пакетов обходится одним пакетным вердиктом
+  message.clear();
+  internal::NetfilterQueue::buildVerdicts(message, sequence, 2, {}, 20);
+  const auto accept_only = parseMessages(message);
+  ASSERT_EQ(accept_only.size(), 1);
+  EXPECT_EQ(accept_only[0].type, batch_type);
+}
+
+
+TEST(NetfilterQueueTest, BuildBindRequest) {
+  for (const bool fail_open : {true, false}) {
+    ::std::vector<internal::byte> message;
+    internal::NetfilterQueue::buildBindRequest(message, 1, 5,
+        internal::NetfilterQueue::Config{.max_length = 1024, .fail_open = fail_open});
+    const auto messages = parseMessages(message);
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0].type, (NFNL_SUBSYS_QUEUE << 8) | NFQNL_MSG_CONFIG);
+    EXPECT_EQ(messages[0].queue_number, 5);
+
+    ::std::map<uint16_t, ::std::vector<internal::byte>> attributes(
+        messages[0].attributes.begin(), messages[0].attributes.end());
+    ASSERT_EQ(attributes.size(), 5);
+    nfqnl_msg_config_cmd command;
+    ::std::memcpy(&command, attributes[NFQA_CFG_CMD].data(), sizeof(command));
+    EXPECT_EQ(command.command, NFQNL_CFG_CMD_BIND);
+    EXPECT_EQ(readBigEndian32(attributes[NFQA_CFG_QUEUE_MAXLEN]), 1024);
+    EXPECT_EQ(readBigEndian32(attributes[NFQA_CFG_MASK]), NFQA_CFG_F_FAIL_OPEN | NFQA_CFG_F_GSO);
+    EXPECT_EQ(readBigEndian32(attributes[NFQA_CFG_FLAGS]) & NFQA_CFG_F_FAIL_OPEN,
+        fail_open ? NFQA_CFG_F_FAIL_OPEN : 0);
+  }
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "packet_buffer_pool.h"
+#include "internal_structs.h"
+
+
+namespace flow_inspector {
+
+
+TEST(PacketBufferPoolTest, SlotsRunOut) {
+  internal::PacketBufferPool pool{internal::PacketBufferPool::Config{.buffer_size = 100, .buffer_count = 2}};
+  internal::PacketBufferPool::Slot first, second, third;
+
+  EXPECT_TRUE(pool.acquireSlot(128, first));
+  EXPECT_TRUE(pool.acquireSlot(10, second));
+  EXPECT_FALSE(pool.acquireSlot(10, third));
+  EXPECT_FALSE(pool.acquireSlot(129, third));
+  // Буферы выровнены по кэш-линии
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first.buffer) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second.buffer) % 64, 0);
+
+  auto statistics = pool.getStatistics();
+  EXPECT_EQ(statistics.buffers, 2);
+  EXPECT_EQ(statistics.buffers_in_use, 2);
+  EXPECT_EQ(statistics.exhausted, 1);
+  EXPECT_EQ(statistics.oversized, 1);
+
+  pool.releaseSlot(first);
+  EXPECT_TRUE(pool.acquireSlot(10, third));
+  EXPECT_EQ(third.buffer, first.buffer);
+  pool.releaseSlot(second);
+  pool.releaseSlot(third);
+  EXPECT_EQ(pool.getStatistics().buffers_in_use, 0);
+}
+
+
+TEST(PacketBufferPoolTest, PacketReturnsBufferWhenDestroyed) {
+  const auto& pool = internal::PacketBufferPool::getThreadPool();
+  ASSERT_TRUE(pool);
+  const auto in_use = pool->getStatistics().buffers_in_use;
+
+  ::std::vector<internal::Packet> packets;
+  packets.emplace_back(internal::rawPacketFromVector({0, 1, 2, 3, 4, 5, 6}), true);
+  EXPECT_EQ(pool->getStatistics().buffers_in_use, in_use + 1);
+  EXPECT_EQ(packets[0].toString(), "[0 1 2 3 4 5 6]");
+
+  // Пакет может быть уничтожен в другом потоке, буфер все равно возвращается в пул создателя
+  ::std::thread([packet = ::std::move(packets[0])]() {}).join();
+  EXPECT_EQ(pool->getStatistics().buffers_in_use, in_use);
+}
+
+
+TEST(PacketBufferPoolTest, ReusedShellsParseNewPackets) {
+  for (int i = 0; i < 3; ++i) {
+    internal::Packet packet{internal::rawPacketFromVector({0, 1, 2, static_cast<internal::byte>(i)}), true};
+    EXPECT_EQ(packet.getParsedPacket().getRawPacket(), packet.packet.get());
+    EXPECT_EQ(packet.getParsedPacket().getRawPacket()->getRawData()[3], i);
+  }
+}
+
+
+TEST(PacketBufferPoolTest, OversizedFrameGoesToHeap) {
+  const auto& pool = internal::PacketBufferPool::getThreadPool();
+  ASSERT_TRUE(pool);
+  const auto before = pool->getStatistics();
+
+  internal::Packet packet{internal::rawPacketFromVector(::std::vector<internal::byte>(4000, 7))};
+  EXPECT_EQ(packet.packet->getRawDataLen(), 4000);
+  EXPECT_EQ(packet.packet->getRawData()[3999], 7);
+  const auto after = pool->getStatistics();
+  EXPECT_EQ(after.oversized, before.oversized + 1);
+  EXPECT_EQ(after.buffers_in_use, before.buffers_in_use);
+  EXPECT_GE(internal::PacketBufferPool::getTotalStatistics().oversized, 1);
+}
+
+
+TEST(PacketBufferPoolTest, SharedPacketKeepsBufferUntilReleased) {
+  const auto& pool = internal::PacketBufferPool::getThreadPool();
+  ASSERT_TRUE(pool);
+  const auto in_use = pool->getStatistics().buffers_in_use;
+
+  internal::SharedPacket shared;
+  {
+    internal::Packet packet{internal::rawPacketFromVector({1, 2, 3, 4})};
+    shared = packet.share();
+    EXPECT_EQ(packet.share(), shared);
+    EXPECT_EQ(shared->packet->getRawData(), packet.packet->getRawData());
+  }
+  EXPECT_EQ(pool->getStatistics().buffers_in_use, in_use + 1);
+  EXPECT_EQ(shared->toString(), "[1 2 3 4]");
+
+  shared.reset();
+  EXPECT_EQ(pool->getStatistics().buffers_in_use, in_use);
+  internal::Packet reused{internal::rawPacketFromVector({5})};
+  EXPECT_EQ(reused.toString(), "[5]");
+}
+
+
+TEST(PacketBufferPoolTest, SharedPacketReleasesCaptureBuffer) {
+  // Внешний буфер ведет себя как блок кольца или пачка кадров XDP: источник ждет, пока его отпустят
+  const ::std::vector<internal::byte> frame{1, 2, 3, 4};
+  bool released = false;
+  internal::SharedPacket shared, retained;
+  {
+    ::std::shared_ptr<const void> holder(frame.data(), [&released](const void*) { released = true; });
+    internal::Packet packet{frame.data(), frame.size(), timespec{}, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET,
+        ::std::move(holder)};
+    shared = packet.share();
+    retained = packet.retain(::std::nullopt);
+    EXPECT_EQ(retained, shared);
+    EXPECT_NE(shared->packet->getRawData(), frame.data());
+    EXPECT_FALSE(released);
+  }
+  EXPECT_TRUE(released);
+  EXPECT_EQ(shared->toString(), "[1 2 3 4]");
+  EXPECT_EQ(shared->share(), shared->share());
+}
+
+
+}  // namespace flow_inspector
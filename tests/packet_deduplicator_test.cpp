@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "packet_blueprint.h"
+#include "packet_deduplicator.h"
+
+
+namespace flow_inspector::internal {
+
+
+namespace {
+
+
+::std::vector<byte> makeFrame(const ::std::string& payload) {
+  PacketBlueprint blueprint;
+  blueprint.transport = PacketBlueprint::Transport::TCP;
+  blueprint.src_ip = 0x0a000001;
+  blueprint.dst_ip = 0x0a000002;
+  blueprint.src_port = 40000;
+  blueprint.dst_port = 80;
+  blueprint.payload.assign(payload.begin(), payload.end());
+  return buildFrame(blueprint);
+}
+
+
+Packet makePacket(const ::std::vector<byte>& frame, long milliseconds) {
+  timespec timestamp{.tv_sec = 1000 + milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000};
+  return Packet{frame.data(), frame.size(), timestamp, ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, nullptr};
+}
+
+
+}  // namespace
+
+
+TEST(PacketDeduplicatorTest, DropsCopyWithinWindow) {
+  PacketDeduplicator deduplicator(PacketDeduplicator::Config{.window_ms = 10});
+  const auto frame = makeFrame("GET / HTTP/1.1");
+
+  EXPECT_FALSE(deduplicator.isDuplicate(makePacket(frame, 0)));
+  EXPECT_TRUE(deduplicator.isDuplicate(makePacket(frame, 5)));
+  EXPECT_FALSE(deduplicator.isDuplicate(makePacket(frame, 100)));
+  EXPECT_EQ(deduplicator.getDuplicatesCount(), 1);
+}
+
+
+TEST(PacketDeduplicatorTest, IgnoresTtlAndVlanTag) {
+  PacketDeduplicator deduplicator(PacketDeduplicator::Config{.window_ms = 10});
+  const auto frame = makeFrame("payload");
+
+  auto other_ttl = frame;
+  other_ttl[14 + 8] -= 1;
+  other_ttl[14 + 10] ^= 0xff;
+
+  auto tagged = frame;
+  const byte vlan_tag[] = {0x81, 0x00, 0x00, 0x2a};
+  tagged.insert(tagged.begin() + 12, ::std::begin(vlan_tag), ::std::end(vlan_tag));
+
+  EXPECT_FALSE(deduplicator.isDuplicate(makePacket(frame, 0)));
+  EXPECT_TRUE(deduplicator.isDuplicate(makePacket(other_ttl, 1)));
+  EXPECT_TRUE(deduplicator.isDuplicate(makePacket(tagged, 2)));
+}
+
+
+TEST(PacketDeduplicatorTest, KeepsDifferentPackets) {
+  PacketDeduplicator deduplicator(PacketDeduplicator::Config{.window_ms = 10});
+  const auto first = makeFrame("first");
+  const auto second = makeFrame("second");
+
+  ::std::vector<Packet> batch;
+  batch.push_back(makePacket(first, 0));
+  batch.push_back(makePacket(first, 0));
+  batch.push_back(makePacket(second, 1));
+  batch.push_back(makePacket(second, 2));
+  batch.push_back(makePacket(first, 3));
+
+  ASSERT_EQ(deduplicator.removeDuplicates(batch), 2);
+  EXPECT_EQ(batch[0], makePacket(first, 0));
+  EXPECT_EQ(batch[1], makePacket(second, 0));
+  EXPECT_EQ(deduplicator.getDuplicatesCount(), 3);
+}
+
+
+}  // namespace flow_inspector::internal
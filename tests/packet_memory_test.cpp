@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include <unistd.h>
+
+#include "packet_buffer_pool.h"
+#include "packet_memory.h"
+
+
+namespace flow_inspector {
+
+
+TEST(PacketMemoryTest, RegularPages) {
+  internal::PacketMemory memory;
+  ASSERT_TRUE(memory.allocate(100, {}));
+
+  const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  EXPECT_EQ(memory.size(), page_size);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(memory.data()) % page_size, 0);
+  EXPECT_FALSE(memory.isHuge());
+  EXPECT_FALSE(memory.isLocked());
+  memory.data()[99] = 7;
+  EXPECT_EQ(memory.data()[99], 7);
+
+  memory.release();
+  EXPECT_EQ(memory.data(), nullptr);
+  EXPECT_EQ(memory.size(), 0);
+}
+
+
+TEST(PacketMemoryTest, HugePagesFallBackToRegularPages) {
+  internal::PacketMemory memory;
+  // Явные huge pages есть не везде, поэтому проверяется только, что память выделена в любом случае
+  ASSERT_TRUE(memory.allocate(4096, internal::PacketMemory::Config{
+    .huge_page_size = internal::PacketMemory::kHugePageSize2M,
+    .lock = true,
+  }));
+  EXPECT_NE(memory.data(), nullptr);
+  if (memory.isHuge()) {
+    EXPECT_EQ(memory.size(), internal::PacketMemory::kHugePageSize2M);
+  }
+  memory.data()[memory.size() - 1] = 1;
+  EXPECT_EQ(memory.data()[memory.size() - 1], 1);
+}
+
+
+TEST(PacketMemoryTest, SmallAreaDoesNotTakeGigabytePage) {
+  internal::PacketMemory memory;
+  const size_t size = size_t{8} << 20;
+  ASSERT_TRUE(memory.allocate(size, internal::PacketMemory::Config{
+    .huge_page_size = internal::PacketMemory::kHugePageSize1G,
+  }));
+  EXPECT_EQ(memory.size(), size);
+}
+
+
+TEST(PacketMemoryTest, PoolUsesLockedMemory) {
+  internal::PacketBufferPool pool{internal::PacketBufferPool::Config{
+    .buffer_size = 100,
+    .buffer_count = 4,
+    .memory = {.huge_page_size = internal::PacketMemory::kHugePageSize2M, .lock = true},
+  }};
+  internal::PacketBufferPool::Slot slot;
+  ASSERT_TRUE(pool.acquireSlot(100, slot));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(slot.buffer) % 64, 0);
+  slot.buffer[99] = 3;
+  pool.releaseSlot(slot);
+  EXPECT_EQ(pool.getStatistics().buffers, 4);
+}
+
+
+}  // namespace flow_inspector
@@ -97,4 +97,54 @@ TEST(PacketProcessorsPoolTest, ProcessLargeNumberOfPacketMultiThread) {
 }
 
 
+TEST(PacketProcessorsPoolTest, ProcessBatchesMultiThread) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+
+  ::std::atomic<size_t> cnt{0};
+
+  {
+    PacketProcessorsPool pool{analyzer, 4};
+    auto callback = [&](auto& packet) {
+      cnt.fetch_add(1);
+    };
+    pool.addCallback(callback);
+
+    PcapReader reader;
+    reader.setProcessor([&](internal::Packet) {
+      FAIL() << "Packets must be delivered in batches";
+    });
+    reader.setBatchProcessor([&](::std::span<internal::Packet> packets) {
+      EXPECT_LE(packets.size(), 256);
+      pool.addPackets(packets);
+    });
+    reader.setFilename("http.pcap");
+    reader.startReading();
+  }
+
+  EXPECT_EQ(cnt.load(), 220);
+}
+
+
+TEST(PacketProcessorsPoolTest, QueueLimitDropsPackets) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+  PacketProcessorsPool pool{analyzer, 0};
+  pool.setMaxQueueDepth(3);
+
+  for (int i = 0; i < 5; ++i) {
+    pool.addPacket(internal::Packet{internal::rawPacketFromVector({1, 2, 3, 4})});
+  }
+  EXPECT_EQ(pool.getQueueDepth(), 3);
+  EXPECT_EQ(pool.getDroppedCount(), 2);
+
+  ::std::vector<internal::Packet> packets;
+  packets.emplace_back(internal::rawPacketFromVector({1, 2, 3, 4}));
+  pool.addPackets(packets);
+  EXPECT_EQ(pool.getQueueDepth(), 3);
+  EXPECT_EQ(pool.getDroppedCount(), 3);
+}
+
 }  // namespace flow_inspector::internal
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "pacer.h"
+#include "pcap_reader.h"
+#include "replay_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+size_t countPackets(const ::std::string& filename) {
+  PcapReader reader;
+  size_t count = 0;
+  reader.setProcessor([&count](internal::Packet) {
+    ++count;
+  });
+  reader.setFilename(filename);
+  reader.startReading();
+  return count;
+}
+
+
+}  // namespace
+
+
+TEST(ReplayReaderTest, ReplayFileSeveralTimes) {
+  ReplayReader reader;
+  size_t count = 0;
+  reader.setProcessor([&count](internal::Packet) {
+    ++count;
+  });
+  reader.setFilename("a_lot_of.pcap");
+  reader.setReplayConfig(ReplayReader::Config{.speed = 0, .loops = 3});
+  reader.startReading();
+
+  EXPECT_EQ(count, 3 * countPackets("a_lot_of.pcap"));
+  EXPECT_NE(reader.getStatistics().find("target unlimited"), ::std::string::npos);
+}
+
+
+TEST(ReplayReaderTest, ReplayAtFixedPacketRate) {
+  const size_t packets_count = countPackets("a_lot_of.pcap");
+  const uint64_t target_pps = packets_count * 10;
+
+  ReplayReader reader;
+  size_t count = 0;
+  reader.setProcessor([&count](internal::Packet) {
+    ++count;
+  });
+  reader.setFilename("a_lot_of.pcap");
+  reader.setReplayConfig(ReplayReader::Config{.target_pps = target_pps});
+
+  const auto start = ::std::chrono::steady_clock::now();
+  reader.startReading();
+  const auto elapsed = ::std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(count, packets_count);
+  // Последний пакет отправляется через (N - 1) / pps после первого
+  EXPECT_GE(elapsed, ::std::chrono::milliseconds(90));
+  EXPECT_LT(elapsed, ::std::chrono::seconds(2));
+}
+
+
+TEST(ReplayReaderTest, PacketRateOffsetDoesNotOverflow) {
+  EXPECT_EQ(internal::Pacer::offsetAtRate(3, 2), ::std::chrono::milliseconds(1500));
+  EXPECT_EQ(internal::Pacer::offsetAtRate(1, 3), ::std::chrono::nanoseconds(333'333'333));
+  // 4e10 пакетов при 10 Mpps - больше часа повторов с --replay-loops 0
+  EXPECT_EQ(internal::Pacer::offsetAtRate(40'000'000'000ull, 10'000'000), ::std::chrono::seconds(4000));
+}
+
+
+TEST(ReplayReaderTest, ReplayMissingFile) {
+  ReplayReader reader;
+  bool processorCalled = false;
+  reader.setProcessor([&processorCalled](internal::Packet) {
+    processorCalled = true;
+  });
+  reader.setFilename("no_such_file.pcap");
+  reader.startReading();
+
+  EXPECT_FALSE(processorCalled);
+  EXPECT_EQ(reader.getStatistics(), "");
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pcap_file_format.h"
+#include "pcap_reader.h"
+#include "shm_ring.h"
+#include "shm_ring_reader.h"
+
+
+namespace flow_inspector {
+
+
+TEST(ShmRingTest, AttachMissingRing) {
+  internal::ShmRing ring;
+  EXPECT_FALSE(ring.attach("flow_inspector_test_missing"));
+  EXPECT_FALSE(ring.isOpen());
+}
+
+
+TEST(ShmRingTest, SlotsReturnAfterRelease) {
+  internal::ShmRing producer;
+  ASSERT_TRUE(producer.create("flow_inspector_test_ring",
+      internal::ShmRing::Config{.slot_count = 4, .slab_size = 4}, ::pcpp::LinkLayerType::LINKTYPE_RAW));
+  internal::ShmRing consumer;
+  ASSERT_TRUE(consumer.attach("flow_inspector_test_ring"));
+  EXPECT_EQ(consumer.getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_RAW);
+
+  const internal::byte data[] = {1, 2, 3, 4, 5, 6};
+  for (internal::byte i = 0; i < 4; ++i) {
+    EXPECT_TRUE(producer.push(data + i, 2, 2, timespec{.tv_sec = i, .tv_nsec = 0}));
+  }
+  EXPECT_FALSE(producer.push(data, 2, 2, timespec{}));
+
+  ::std::vector<internal::Packet> packets;
+  auto handler = [&packets](internal::Packet packet) {
+    packets.push_back(::std::move(packet));
+  };
+  EXPECT_EQ(consumer.read(3, handler), 3);
+  EXPECT_EQ(consumer.read(3, handler), 1);
+  ASSERT_EQ(packets.size(), 4);
+  EXPECT_EQ(packets[2].toString(), "[3 4]");
+  EXPECT_EQ(packets[3].packet->getPacketTimeStamp().tv_sec, 3);
+
+  // Слоты возвращаются писателю только после того, как отпущены пакеты
+  EXPECT_FALSE(producer.push(data, 2, 2, timespec{}));
+  packets.clear();
+  EXPECT_EQ(consumer.read(3, handler), 0);
+  EXPECT_TRUE(producer.isDrained());
+
+  // Кадр длиннее слаба обрезается
+  EXPECT_TRUE(producer.push(data, 6, 6, timespec{}));
+  producer.finish();
+  EXPECT_FALSE(consumer.isFinished());
+  EXPECT_EQ(consumer.read(3, handler), 1);
+  EXPECT_EQ(packets[0].toString(), "[1 2 3 4]");
+  EXPECT_TRUE(consumer.isFinished());
+}
+
+
+TEST(ShmRingReaderTest, SameAsPcapReader) {
+  ::std::vector<internal::Packet> expectedPackets;
+  PcapReader pcapReader;
+  pcapReader.setProcessor([&expectedPackets](internal::Packet packet) {
+    expectedPackets.push_back(::std::move(packet));
+  });
+  pcapReader.setFilename("a_lot_of.pcap");
+  pcapReader.startReading();
+
+  auto file = internal::mapPcapFile("a_lot_of.pcap");
+  ASSERT_TRUE(file);
+  internal::ShmRing producer;
+  ASSERT_TRUE(producer.create("flow_inspector_test_reader",
+      internal::ShmRing::Config{.slot_count = 16, .slab_size = 2048}, file->info.link_type));
+
+  ::std::vector<internal::Packet> capturedPackets;
+  ShmRingReader reader;
+  reader.setRingName("flow_inspector_test_reader");
+  EXPECT_EQ(reader.getLinkLayerType(), pcapReader.getLinkLayerType());
+
+  // Кольцо меньше файла, поэтому писатель ждет, пока читатель освободит слоты
+  ::std::thread writer([&producer, &file]() {
+    size_t offset = internal::kPcapFileHeaderSize;
+    internal::PcapRecord record;
+    while (const size_t record_size = internal::parsePcapRecord(
+        file->data + offset, file->size - offset, file->info, record)) {
+      while (!producer.push(record.data, record.captured_length, record.original_length, record.timestamp)) {
+        ::std::this_thread::yield();
+      }
+      offset += record_size;
+    }
+    producer.finish();
+  });
+  // Пакеты копируются, чтобы читатель мог вернуть слоты писателю
+  reader.setProcessor([&capturedPackets](internal::Packet packet) {
+    capturedPackets.emplace_back(*packet.packet);
+  });
+  reader.startReading();
+  writer.join();
+
+  ASSERT_EQ(capturedPackets.size(), expectedPackets.size());
+  for (size_t i = 0; i < capturedPackets.size(); ++i) {
+    EXPECT_EQ(capturedPackets[i], expectedPackets[i]);
+  }
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pcap_reader.h"
+#include "stream_pcap_reader.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+::std::vector<internal::Packet> readWithPcapReader(const ::std::string& filename) {
+  ::std::vector<internal::Packet> packets;
+  PcapReader reader;
+  reader.setProcessor([&packets](internal::Packet packet) {
+    packets.push_back(::std::move(packet));
+  });
+  reader.setFilename(filename);
+  reader.startReading();
+  return packets;
+}
+
+
+}  // namespace
+
+
+TEST(StreamPcapReaderTest, DetectsStreams) {
+  EXPECT_TRUE(StreamPcapReader::isStream("-"));
+  EXPECT_FALSE(StreamPcapReader::isStream("a_lot_of.pcap"));
+  EXPECT_FALSE(StreamPcapReader::isStream("no_such_file.pcap"));
+}
+
+
+TEST(StreamPcapReaderTest, ReadEmptyPcap) {
+  StreamPcapReader reader;
+  bool processorCalled = false;
+
+  reader.setProcessor([&processorCalled](internal::Packet) {
+    processorCalled = true;
+  });
+
+  reader.setFilename("empty.pcap");
+  reader.startReading();
+
+  EXPECT_FALSE(processorCalled);
+}
+
+
+TEST(StreamPcapReaderTest, SameAsPcapReaderAcrossBlocks) {
+  const auto expectedPackets = readWithPcapReader("http.pcap");
+
+  ::std::vector<internal::Packet> capturedPackets;
+  StreamPcapReader reader;
+  reader.setProcessor([&capturedPackets](internal::Packet packet) {
+    capturedPackets.push_back(::std::move(packet));
+  });
+  // Файл больше блока, поэтому записи на границе переносятся в следующий блок
+  reader.setBlockSize(0);
+  reader.setFilename("http.pcap");
+  EXPECT_EQ(reader.getLinkLayerType(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET);
+  reader.startReading();
+
+  ASSERT_EQ(capturedPackets.size(), expectedPackets.size());
+  for (size_t i = 0; i < capturedPackets.size(); ++i) {
+    EXPECT_EQ(capturedPackets[i], expectedPackets[i]);
+    EXPECT_EQ(capturedPackets[i].packet->getPacketTimeStamp().tv_nsec,
+        expectedPackets[i].packet->getPacketTimeStamp().tv_nsec);
+  }
+}
+
+
+TEST(StreamPcapReaderTest, ReadsFifo) {
+  const ::std::string fifo = "stream_pcap_reader_test.fifo";
+  ::unlink(fifo.c_str());
+  ASSERT_EQ(::mkfifo(fifo.c_str(), 0600), 0);
+
+  ::std::ifstream input{"a_lot_of.pcap", ::std::ios::binary};
+  const ::std::string content{::std::istreambuf_iterator<char>(input), ::std::istreambuf_iterator<char>()};
+  ::std::thread writer([&fifo, &content]() {
+    ::std::ofstream output{fifo, ::std::ios::binary};
+    // Мелкие записи заставляют читателя собирать заголовки и записи по частям
+    for (size_t offset = 0; offset < content.size(); offset += 1000) {
+      output.write(content.data() + offset, ::std::min<size_t>(1000, content.size() - offset));
+      output.flush();
+    }
+  });
+
+  ::std::vector<internal::Packet> capturedPackets;
+  StreamPcapReader reader;
+  reader.setProcessor([&capturedPackets](internal::Packet packet) {
+    capturedPackets.push_back(::std::move(packet));
+  });
+  EXPECT_TRUE(StreamPcapReader::isStream(fifo));
+  reader.setFilename(fifo);
+  reader.startReading();
+  writer.join();
+  ::unlink(fifo.c_str());
+
+  const auto expectedPackets = readWithPcapReader("a_lot_of.pcap");
+  ASSERT_EQ(capturedPackets.size(), expectedPackets.size());
+  for (size_t i = 0; i < capturedPackets.size(); ++i) {
+    EXPECT_EQ(capturedPackets[i], expectedPackets[i]);
+  }
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "traffic_capturer.h"
+
+
+namespace flow_inspector {
+
+
+TEST(TrafficCapturerTest, BufferKeptWithoutDrops) {
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(0, 0, 256 << 20), 0);
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(0, 4 << 20, 256 << 20), 4 << 20);
+}
+
+
+TEST(TrafficCapturerTest, DefaultBufferGrowsToInitialSize) {
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(1, 0, 256 << 20), TrafficCapturer::kAutoTuneInitialBufferSize);
+}
+
+
+TEST(TrafficCapturerTest, BufferDoublesOnDrops) {
+  int buffer_size = TrafficCapturer::kAutoTuneInitialBufferSize;
+  buffer_size = TrafficCapturer::tuneBufferSize(10, buffer_size, 256 << 20);
+  EXPECT_EQ(buffer_size, 4 << 20);
+  buffer_size = TrafficCapturer::tuneBufferSize(10, buffer_size, 256 << 20);
+  EXPECT_EQ(buffer_size, 8 << 20);
+}
+
+
+TEST(TrafficCapturerTest, BufferCappedAtMaximum) {
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(1, 200 << 20, 256 << 20), 256 << 20);
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(1, 256 << 20, 256 << 20), 256 << 20);
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(1, 0, 1 << 20), 1 << 20);
+
+  // Удвоение не должно переполнять int рядом с его пределом
+  const int max = ::std::numeric_limits<int>::max();
+  EXPECT_EQ(TrafficCapturer::tuneBufferSize(1, max / 2 + 1, max), max);
+}
+
+
+}  // namespace flow_inspector
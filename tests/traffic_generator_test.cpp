@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "analyzer.h"
+#include "decapsulation.h"
+#include "packet_blueprint.h"
+#include "traffic_generator.h"
+
+
+namespace flow_inspector {
+
+
+namespace {
+
+
+::std::vector<::std::string> generatePackets(const TrafficGenerator::Config& config) {
+  TrafficGenerator generator;
+  ::std::vector<::std::string> packets;
+  generator.setProcessor([&packets](internal::Packet packet) {
+    packets.push_back(packet.toString());
+  });
+  generator.setGeneratorConfig(config);
+  generator.startReading();
+  return packets;
+}
+
+
+}  // namespace
+
+
+TEST(TrafficGeneratorTest, SameSeedGivesSameTraffic) {
+  const auto first = generatePackets(TrafficGenerator::Config{.seed = 7, .packets = 300});
+  const auto second = generatePackets(TrafficGenerator::Config{.seed = 7, .packets = 300});
+  const auto other = generatePackets(TrafficGenerator::Config{.seed = 8, .packets = 300});
+
+  EXPECT_EQ(first.size(), 300);
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+}
+
+
+TEST(TrafficGeneratorTest, ProtocolMixAndSizes) {
+  TrafficGenerator generator;
+  size_t tcp = 0, udp = 0, icmp = 0, bad_size = 0;
+  generator.setProcessor([&](internal::Packet packet) {
+    const auto size = packet.packet->getRawDataLen();
+    if (size < 100 || size > 200) {
+      ++bad_size;
+    }
+    packet.parse();
+    const auto& parsed = packet.getParsedPacket();
+    tcp += parsed.isPacketOfType(::pcpp::TCP);
+    udp += parsed.isPacketOfType(::pcpp::UDP);
+    icmp += parsed.isPacketOfType(::pcpp::ICMP);
+  });
+  generator.setGeneratorConfig(TrafficGenerator::Config{
+      .flows = 64, .min_size = 100, .max_size = 200, .packets = 3000,
+      .tcp_weight = 1, .udp_weight = 1, .icmp_weight = 1});
+  generator.setWorkersCount(3);
+  generator.startReading();
+
+  EXPECT_EQ(tcp + udp + icmp, 3000);
+  EXPECT_GT(tcp, 0);
+  EXPECT_GT(udp, 0);
+  EXPECT_GT(icmp, 0);
+  EXPECT_EQ(bad_size, 0);
+}
+
+
+TEST(TrafficGeneratorTest, HitPercentControlsAlerts) {
+  Logger logger;
+  EventsHandler handler{logger};
+  Analyzer analyzer{logger, handler};
+  EXPECT_TRUE(analyzer.parseRule("Alert; web; ip([any],[10.0.0.0/16]); tcp([any], [80]); content(tcp, GET)"));
+  EXPECT_EQ(analyzer.getRuleBlueprints().size(), 1);
+
+  size_t alerts = 0;
+  handler.addEventCallback(internal::Event::EventType::Alert, [&alerts](const internal::Event&) {
+    ++alerts;
+  });
+
+  for (const double hit_percent : {0.0, 100.0}) {
+    alerts = 0;
+    TrafficGenerator generator;
+    generator.setProcessor([&analyzer](internal::Packet packet) {
+      packet.parse();
+      analyzer.detectThreats(packet);
+    });
+    generator.setRuleBlueprints(analyzer.getRuleBlueprints());
+    generator.setGeneratorConfig(TrafficGenerator::Config{.hit_percent = hit_percent, .packets = 200});
+    generator.startReading();
+    EXPECT_EQ(alerts, hit_percent > 0 ? 200 : 0);
+  }
+}
+
+
+TEST(TrafficGeneratorTest, RawBytesKeepHeadersConsistent) {
+  constexpr size_t kIpOffset{14};
+  constexpr size_t kUdpOffset{kIpOffset + 20};
+  internal::PacketBlueprint blueprint{
+    .transport = internal::PacketBlueprint::Transport::UDP,
+    .src_ip = 0x0a000001,
+    .dst_ip = 0x0a000002,
+    .src_port = 5000,
+    .dst_port = 53,
+    .payload = {'a', 'b'},
+    // Байты за концом нагрузки и байт поверх TTL в IP-заголовке
+    .raw_bytes = {{60, {1, 2, 3}}, {kIpOffset + 8, {7}}},
+  };
+  const auto frame = internal::buildFrame(blueprint);
+  ASSERT_EQ(frame.size(), 63);
+
+  const auto read16 = [&frame](size_t offset) {
+    return static_cast<size_t>(frame[offset] << 8 | frame[offset + 1]);
+  };
+  EXPECT_EQ(read16(kIpOffset + 2), frame.size() - kIpOffset);
+  EXPECT_EQ(read16(kUdpOffset + 4), frame.size() - kUdpOffset);
+  EXPECT_EQ(frame[kIpOffset + 8], 7);
+  uint32_t sum = 0;
+  for (size_t i = kIpOffset; i < kUdpOffset; i += 2) {
+    sum += read16(i);
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  EXPECT_EQ(sum, 0xffff);
+
+  internal::PacketView view;
+  ASSERT_TRUE(internal::decapsulate(frame.data(), frame.size(), ::pcpp::LinkLayerType::LINKTYPE_ETHERNET, view));
+  EXPECT_EQ(view.payload.size(), frame.size() - kUdpOffset - 8);
+}
+
+
+}  // namespace flow_inspector
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "RawPacket.h"
+
+#include "internal_structs.h"
+#include "xdp_capturer.h"
+
+
+namespace flow_inspector {
+
+
+TEST(XdpCapturerTest, BatchIsCopiedOutOfUmem) {
+  XdpCapturer capturer;
+  ::std::vector<internal::Packet> received;
+  capturer.setBatchProcessor([&received](::std::span<internal::Packet> packets) {
+    for (auto& packet : packets) {
+      received.push_back(::std::move(packet));
+    }
+  });
+
+  ::std::vector<internal::byte> umem{1, 2, 3, 4, 5, 6};
+  const ::pcpp::RawPacket packets[] = {
+    ::pcpp::RawPacket{umem.data(), 3, timespec{}, false},
+    ::pcpp::RawPacket{umem.data() + 3, 3, timespec{}, false},
+  };
+  capturer.receiveBatch(packets, 2);
+  // После возврата из колбэка XdpDevice отдает кадры обратно в fill ring, и ядро их перезаписывает
+  ::std::fill(umem.begin(), umem.end(), 0);
+
+  ASSERT_EQ(received.size(), 2);
+  EXPECT_EQ(received[0].toString(), "[1 2 3]");
+  EXPECT_EQ(received[1].toString(), "[4 5 6]");
+}
+
+
+TEST(XdpCapturerTest, MissingInterface) {
+  XdpCapturer capturer;
+  capturer.setInterfaceName("flow_inspector_missing0");
+  capturer.startReading();
+  EXPECT_EQ(capturer.getStatistics(), "");
+}
+
+
+}  // namespace flow_inspector